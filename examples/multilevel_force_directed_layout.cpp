@@ -0,0 +1,11 @@
+#include "graphw.hpp"
+#include "graphw_draw.hpp"
+
+int main() {
+    // Construct multilevel force directed layout
+    graphw::MultilevelForceDirectedLayout g;
+    // Add circular ladder to graph
+    g.add_circular_ladder(1000);
+    // Draw graph
+    graphw::draw(g);
+}
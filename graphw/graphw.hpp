@@ -1,115 +1,625 @@
 #ifndef GRAPHW
 #define GRAPHW
 
+#include <errno.h>
+#include <fcntl.h>
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <exception>
+#include <iterator>
+#include <limits>
 #include <list>
+#include <map>
+#include <ostream>
 #include <queue>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace graphw {
-struct Node {
-    int id;
+// Type of node ids and node counts. Define GRAPHW_64BIT_IDS before including
+// graphw to handle graphs with more than 2^31 - 1 nodes, at the cost of twice
+// the memory per stored id.
+#ifdef GRAPHW_64BIT_IDS
+typedef int64_t NodeId;
+#else
+typedef int32_t NodeId;
+#endif
+
+// Type of edge counts, which only take a few words per graph so are always 64
+// bits wide
+typedef int64_t EdgeCount;
+
+// Direction policies of a BasicGraph. The direction of Directed and
+// Undirected graphs is fixed at compile time, RuntimeDirected graphs choose it
+// when constructed.
+struct Directed {};
+struct Undirected {};
+struct RuntimeDirected {};
+
+// Label policies of a BasicGraph. StringLabels keeps a table of arbitrary
+// labels, IntegerLabels labels every node by its id and stores no labels.
+struct StringLabels {};
+struct IntegerLabels {};
+
+// Edge payload of a BasicGraph which stores nothing
+struct NoPayload {};
+
+// Entry of an adjacency list, holding the id of a neighbor along with its
+// label and the payload of the edge if the graph stores them
+template <typename IdType, typename LabelPolicy, typename EdgePayload>
+struct BasicNode {
+    IdType id;
     std::string label;
+    EdgePayload payload;
+};
+
+template <typename IdType, typename EdgePayload>
+struct BasicNode<IdType, IntegerLabels, EdgePayload> {
+    IdType id;
+    EdgePayload payload;
+};
+
+template <typename IdType>
+struct BasicNode<IdType, StringLabels, NoPayload> {
+    IdType id;
+    std::string label;
+};
+
+template <typename IdType>
+struct BasicNode<IdType, IntegerLabels, NoPayload> {
+    IdType id;
+};
+
+typedef BasicNode<NodeId, StringLabels, NoPayload> Node;
+
+struct Position {
+    int x;
+    int y;
+};
+
+struct PositionFloat {
+    float x;
+    float y;
 };
 
 struct GraphwError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
-class Graph {
+namespace detail {
+// Read-only memory mapping of an entire file
+class MappedFile {
+   public:
+    explicit MappedFile(const std::string& path, bool sequential = true)
+        : data_(nullptr), size_(0) {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw GraphwError("Could not open file: " + path);
+        }
+        struct stat file_stat;
+        if (fstat(fd_, &file_stat) < 0) {
+            ::close(fd_);
+            throw GraphwError("Could not read file size: " + path);
+        }
+        size_ = (size_t)(file_stat.st_size);
+        if (size_ > 0) {
+            // Mapping an empty file is an error, so leave data_ as nullptr
+            void* address =
+                mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (address == MAP_FAILED) {
+                ::close(fd_);
+                throw GraphwError("Could not map file: " + path);
+            }
+            madvise(address, size_,
+                    sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+            data_ = static_cast<const char*>(address);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+        ::close(fd_);
+    }
+
+    inline const char* data() const { return data_; }
+
+    inline size_t size() const { return size_; }
+
+   private:
+    int fd_;
+    const char* data_;
+    size_t size_;
+};
+
+// Split a buffer into at most count [begin, end) ranges which all end on a
+// newline boundary (or the end of the buffer)
+inline std::vector<std::pair<size_t, size_t> > split_lines(const char* data,
+                                                           size_t size,
+                                                           size_t count) {
+    std::vector<std::pair<size_t, size_t> > chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= count && begin < size; i++) {
+        size_t end = std::max(begin, (size / count) * i);
+        if (i == count || end >= size) {
+            end = size;
+        } else {
+            const void* newline = memchr(data + end, '\n', size - end);
+            end = (newline == nullptr)
+                      ? size
+                      : (size_t)(static_cast<const char*>(newline) - data) + 1;
+        }
+        chunks.push_back(std::make_pair(begin, end));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Return the number of worker threads to use for n independent tasks
+inline size_t thread_count(size_t n) {
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<size_t>(1, std::min(n, hardware));
+}
+
+// Call function(i) for every i in [0, n) across a group of threads, the first
+// exception thrown by any task is rethrown on the calling thread
+template <typename Function>
+void parallel_for(size_t n, Function function) {
+    size_t threads_size = thread_count(n);
+    if (threads_size <= 1) {
+        for (size_t i = 0; i < n; i++) {
+            function(i);
+        }
+        return;
+    }
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::atomic<bool> failed(false);
+    auto worker = [&]() {
+        size_t i;
+        while (!failed.load() && (i = next.fetch_add(1)) < n) {
+            try {
+                function(i);
+            } catch (...) {
+                if (!failed.exchange(true)) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threads_size; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Parse the lines of a buffer in windows of bounded size. For each window,
+// parse(begin, end, result) runs on slices ending at newlines in parallel and
+// consume(result) then runs on the calling thread for every slice in order.
+// Result must provide clear().
+template <typename Result, typename Parse, typename Consume>
+void parse_lines(const char* data, size_t size, Parse parse, Consume consume) {
+    const size_t slice_size = (size_t)(1) << 24;
+    size_t slices = thread_count(size / slice_size + 1);
+    std::vector<Result> results(slices);
+    size_t begin = 0;
+    while (begin < size) {
+        // Extend the window to the end of its last line
+        size_t end = std::min(size, begin + (slices * slice_size));
+        if (end < size) {
+            const void* newline = memchr(data + end, '\n', size - end);
+            end = (newline == nullptr)
+                      ? size
+                      : (size_t)(static_cast<const char*>(newline) - data) + 1;
+        }
+        std::vector<std::pair<size_t, size_t> > chunks =
+            split_lines(data + begin, end - begin, slices);
+        parallel_for(chunks.size(), [&](size_t i) {
+            results[i].clear();
+            parse(data + begin + chunks[i].first,
+                  data + begin + chunks[i].second, results[i]);
+        });
+        for (size_t i = 0; i < chunks.size(); i++) {
+            consume(results[i]);
+        }
+        begin = end;
+    }
+}
+
+// Write all of data to a file descriptor, retrying partial writes
+inline void write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw GraphwError("Could not write to file descriptor");
+        }
+        data += written;
+        size -= (size_t)(written);
+    }
+}
+
+// Format count items and pass them to sink(data, size) in pieces of bounded
+// size. Items are grouped into ranges of about range_weight total weight,
+// where item i weighs weight(i) + 1, and format(begin, end, buffer) appends the
+// items of one range to its buffer. If parallel is set, each batch of ranges is
+// formatted by a group of threads before being passed on in order. Parallel
+// ranges are larger and every thread gets several of them per batch, so that
+// starting the group of threads for a batch costs little next to formatting
+// it.
+template <typename Weight, typename Format, typename Sink>
+void write_ranges(size_t count, Weight weight, Format format, Sink sink,
+                  bool parallel) {
+    const size_t range_weight = parallel ? (size_t)(1) << 16 : 4096;
+    size_t batch_size = parallel ? 4 * thread_count(count) : 1;
+    std::vector<std::string> buffers(batch_size);
+    std::vector<size_t> bounds;
+    size_t item = 0;
+    while (item < count) {
+        // Find the bounds of the ranges in this batch
+        bounds.assign(1, item);
+        size_t total = 0;
+        while (item < count && bounds.size() <= batch_size) {
+            total += weight(item) + 1;
+            item++;
+            if (total >= range_weight || item == count) {
+                bounds.push_back(item);
+                total = 0;
+            }
+        }
+        parallel_for(bounds.size() - 1, [&](size_t i) {
+            buffers[i].clear();
+            format(bounds[i], bounds[i + 1], buffers[i]);
+        });
+        for (size_t i = 0; i + 1 < bounds.size(); i++) {
+            sink(buffers[i].data(), buffers[i].size());
+        }
+    }
+}
+
+// Return whether c separates tokens in an edge list
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Return the ids of nodes in reverse Cuthill-McKee order given symmetric
+// adjacency lists. Each connected component is traversed breadth first from a
+// node of minimum degree, visiting neighbors by increasing degree.
+template <typename Id>
+std::vector<Id> reverse_cuthill_mckee_order(
+    const std::vector<std::vector<Id> >& adjacency) {
+    size_t n = adjacency.size();
+    auto by_degree = [&adjacency](Id id1, Id id2) {
+        return adjacency[id1].size() < adjacency[id2].size();
+    };
+    std::vector<Id> starts(n);
+    for (size_t i = 0; i < n; i++) {
+        starts[i] = (Id)(i);
+    }
+    std::stable_sort(starts.begin(), starts.end(), by_degree);
+    std::vector<Id> order;
+    order.reserve(n);
+    std::vector<char> visited(n, 0);
+    std::vector<Id> next;
+    for (Id start : starts) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = 1;
+        order.push_back(start);
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            next.clear();
+            for (Id neighbor_id : adjacency[order[head]]) {
+                if (!visited[neighbor_id]) {
+                    visited[neighbor_id] = 1;
+                    next.push_back(neighbor_id);
+                }
+            }
+            std::stable_sort(next.begin(), next.end(), by_degree);
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Return the ids of nodes by descending degree, keeping the current order of
+// nodes with the same degree
+template <typename Id>
+std::vector<Id> degree_order(
+    const std::vector<std::vector<Id> >& adjacency) {
+    std::vector<Id> order(adjacency.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = (Id)(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&adjacency](Id a, Id b) {
+                         return adjacency[a].size() > adjacency[b].size();
+                     });
+    return order;
+}
+
+// Return the ids of nodes with above average degree followed by the other
+// nodes, both in their current order
+template <typename Id>
+std::vector<Id> hub_cluster_order(
+    const std::vector<std::vector<Id> >& adjacency) {
+    size_t entries = 0;
+    for (auto const& neighbors : adjacency) {
+        entries += neighbors.size();
+    }
+    std::vector<Id> order(adjacency.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = (Id)(i);
+    }
+    std::stable_partition(order.begin(), order.end(), [&](Id id) {
+        return adjacency[id].size() * adjacency.size() > entries;
+    });
+    return order;
+}
+
+// Return the ids of nodes in Gorder order given symmetric adjacency lists.
+// Nodes are placed one at a time, choosing the node with the most neighbors
+// and shared neighbors among the last window placed nodes.
+template <typename Id>
+std::vector<Id> gorder_order(
+    const std::vector<std::vector<Id> >& adjacency, size_t window = 5) {
+    size_t n = adjacency.size();
+    std::vector<Id> order;
+    order.reserve(n);
+    std::vector<Id> score(n, 0);
+    std::vector<char> placed(n, 0);
+    // Entries are (score, -id) so ties go to the lowest id. Entries whose
+    // score is out of date are skipped when popped.
+    std::priority_queue<std::pair<Id, Id> > queue;
+    // Like the original Gorder, neighbors with a very high degree are not
+    // used to find shared neighbors since they would touch most of the graph
+    size_t hub_degree = std::max<size_t>(16, (size_t)(sqrt((double)(n))));
+    auto add = [&](Id id, Id delta) {
+        if (!placed[id]) {
+            score[id] += delta;
+            queue.push({score[id], -id});
+        }
+    };
+    auto update = [&](Id id, Id delta) {
+        for (Id neighbor_id : adjacency[id]) {
+            add(neighbor_id, delta);
+            if (adjacency[neighbor_id].size() <= hub_degree) {
+                for (Id sibling_id : adjacency[neighbor_id]) {
+                    add(sibling_id, delta);
+                }
+            }
+        }
+    };
+    size_t unplaced = 0;
+    while (order.size() < n) {
+        Id id = -1;
+        while (!queue.empty() && id < 0) {
+            std::pair<Id, Id> top = queue.top();
+            queue.pop();
+            if (!placed[-top.second] && top.first == score[-top.second] &&
+                top.first > 0) {
+                id = -top.second;
+            }
+        }
+        if (id < 0 && order.empty()) {
+            // Start from a node of maximum degree
+            id = degree_order(adjacency)[0];
+        } else if (id < 0) {
+            // Continue from the first node which is not placed
+            while (placed[unplaced]) {
+                unplaced++;
+            }
+            id = (Id)(unplaced);
+        }
+        placed[id] = 1;
+        order.push_back(id);
+        update(id, 1);
+        if (order.size() > window) {
+            update(order[order.size() - 1 - window], -1);
+        }
+    }
+    return order;
+}
+}  // namespace detail
+
+// Ways to renumber the nodes of a graph so that neighbors are stored close
+// together
+enum class Ordering {
+    // Reverse Cuthill-McKee, which keeps the ids of neighbors close
+    reverse_cuthill_mckee,
+    // Nodes by descending degree
+    degree,
+    // Nodes with above average degree first
+    hub_cluster,
+    // Gorder, which places nodes next to those they share neighbors with
+    gorder
+};
+
+class ConcurrentGraphBuilder;
+class GraphView;
+
+// Graph stored as adjacency lists, specialized at compile time by policies.
+// DirectionPolicy is Directed, Undirected or RuntimeDirected, LabelPolicy is
+// StringLabels or IntegerLabels, IdType is the integer type of node ids and
+// EdgePayload is stored in every adjacency list entry. With fixed policies the
+// branches on direction and labels are resolved by the compiler, and an
+// IntegerLabels graph stores nothing but neighbor ids. Graph is the
+// instantiation with a runtime direction and string labels.
+template <typename DirectionPolicy = RuntimeDirected,
+          typename LabelPolicy = StringLabels, typename IdType = NodeId,
+          typename EdgePayload = NoPayload>
+class BasicGraph {
+    static_assert(std::is_same<LabelPolicy, StringLabels>::value ||
+                      std::is_same<LabelPolicy, IntegerLabels>::value,
+                  "LabelPolicy must be StringLabels or IntegerLabels");
+    static_assert(std::is_same<DirectionPolicy, Directed>::value ||
+                      std::is_same<DirectionPolicy, Undirected>::value ||
+                      std::is_same<DirectionPolicy, RuntimeDirected>::value,
+                  "DirectionPolicy must be Directed, Undirected or "
+                  "RuntimeDirected");
+
    public:
+    // Type of node ids in this graph
+    typedef IdType NodeId;
+    // Type of adjacency list entries in this graph
+    typedef BasicNode<IdType, LabelPolicy, EdgePayload> Node;
+    // Type returned by label, labels are formatted on demand if they are not
+    // stored
+    typedef typename std::conditional<
+        std::is_same<LabelPolicy, StringLabels>::value, const std::string&,
+        std::string>::type Label;
+
     std::vector<std::vector<Node> > graph;
 
-    Graph(bool new_directed_ = false) : edges(0), directed_(new_directed_) {}
+    BasicGraph(bool new_directed_ = std::is_same<DirectionPolicy,
+                                                 Directed>::value)
+        : edges(0),
+          directed_(new_directed_),
+          in_edge_index_(false),
+          version_(0),
+          stride(0),
+          dense_(false),
+          dense_automatic_(false),
+          dense_threshold_(0.05) {
+        check_direction(new_directed_);
+    }
 
     // Add node with given label, node will not be added if
-    // the label already exists. Returns the node created.
+    // the label already exists. Returns the node created. With integer
+    // labels the label must be a node id, and every node with a lower id which
+    // does not exist yet is added as well.
     Node add_node(std::string label = "") {
-        int id = (int)(graph.size());
+        NodeId id = (NodeId)(graph.size());
         if (label.empty()) {
             // No label was set, make label equal id
             label = std::to_string(id);
         }
-        Node node = get_node(label);
-        if (labels.insert(label).second) {
-            // Label does not exist
-            // Add node to graph
-            std::vector<Node> neighbors;
-            graph.push_back(neighbors);
-            identities[label] = id;
-            labels_vector.push_back(label);
+        if constexpr (labelled) {
+            if (!identities.emplace(label, id).second) {
+                // Node already exists
+                throw GraphwError("Could not add node with duplicate label");
+            }
+            push_node(std::move(label));
         } else {
-            // Node already exists
-            throw GraphwError("Could not add node with duplicate label");
+            id = parse_id(label);
+            if (id < (NodeId)(graph.size())) {
+                throw GraphwError("Could not add node with duplicate label");
+            }
+            while ((NodeId)(graph.size()) <= id) {
+                push_node(std::string());
+            }
         }
-        return node;
+        return entry(id, EdgePayload());
     }
 
     // Add an edge between two nodes given two node labels
-    void add_edge(std::string label1, std::string label2) {
-        int nodes_created = 0;
-        // Increment edges counter
-        edges++;
+    void add_edge(std::string label1, std::string label2,
+                  const EdgePayload& payload = EdgePayload()) {
+        NodeId nodes_created = 0;
         // Check if labels exist
-        if (labels.find(label1) == labels.end()) {
+        if (find(label1) < 0) {
             // Label1 does not exist, add node with label1
             add_node(label1);
             nodes_created++;
         }
-        if (labels.find(label2) == labels.end()) {
+        if (find(label2) < 0) {
             // Label2 does not exist, add node with label2
             add_node(label2);
             nodes_created++;
         }
+        NodeId id1 = find(label1);
+        NodeId id2 = find(label2);
+        // Increment edges counter once both nodes exist, since adding either
+        // one can throw
+        edges++;
         // Check if edge already exists if both labels existed before
-        if (nodes_created > 0 || (!are_neighbors(label1, label2))) {
-            // Define new nodes based one label1 and label2
-            Node node1 = {identities[label1], label1};
-            Node node2 = {identities[label2], label2};
-            graph[node1.id].push_back(node2);
-            if (!directed_) {
-                graph[node2.id].push_back(node1);
+        if (nodes_created > 0 || (!linked(id1, id2) && !linked(id2, id1))) {
+            link(id1, entry(id2, payload));
+            if (!directed()) {
+                link(id2, entry(id1, payload));
             }
         }
+        check_density();
     }
 
     // Add an edge between two nodes given two node instances
-    void add_edge(Node node1_, Node node2_) {
-        int nodes_created = 0;
-        // Increment edges counter
-        edges++;
+    void add_edge(Node node1_, Node node2_,
+                  const EdgePayload& payload = EdgePayload()) {
+        NodeId nodes_created = 0;
         Node node1 = node1_;
         Node node2 = node2_;
         if (!does_node_exist(node1)) {
-            node1 = add_node(node1_.label);
+            node1 = add_node(node_label(node1_));
             nodes_created++;
         }
         if (!does_node_exist(node2)) {
-            node2 = add_node(node2_.label);
+            node2 = add_node(node_label(node2_));
             nodes_created++;
         }
+        // Increment edges counter once both nodes exist
+        edges++;
         // Check if edge already exists if both labels existed before
-        if (nodes_created > 0 || (!are_neighbors(node1.label, node2.label))) {
-            graph[node1.id].push_back(node2);
-            if (!directed_) {
-                graph[node2.id].push_back(node1);
+        if (nodes_created > 0 ||
+            (!linked(node1.id, node2.id) && !linked(node2.id, node1.id))) {
+            link(node1.id, entry(node2.id, payload));
+            if (!directed()) {
+                link(node2.id, entry(node1.id, payload));
             }
         }
+        check_density();
+    }
+
+    // Add an edge between two nodes given two node ids. With integer labels
+    // nodes which do not exist are added, otherwise both ids must exist.
+    // Unlike the other overloads, duplicate edges are not filtered out.
+    void add_edge(NodeId id1, NodeId id2,
+                  const EdgePayload& payload = EdgePayload()) {
+        NodeId max_id = std::max(id1, id2);
+        if (std::min(id1, id2) < 0 ||
+            (labelled && max_id >= (NodeId)(graph.size()))) {
+            throw GraphwError("Node id out of range: " +
+                              std::to_string(id1 < 0 ? id1 : max_id));
+        }
+        while ((NodeId)(graph.size()) <= max_id) {
+            push_node(std::string());
+        }
+        append_edge(id1, id2, payload);
+        check_density();
     }
 
     // Add a path given a list of labels representing nodes
     void add_path(const std::list<std::string>& labels_list) {
-        int current_label = 0;
+        NodeId current_label = 0;
         std::string previous_label;
         for (auto const& label : labels_list) {
-            if (labels.find(label) == labels.end()) {
+            if (find(label) < 0) {
                 // Label does not exist, add node with label
                 add_node(label);
             }
@@ -123,11 +633,11 @@ class Graph {
 
     // Add a path given a list of nodes
     void add_path(const std::list<Node>& nodes_list) {
-        int current_node = 0;
+        NodeId current_node = 0;
         Node previous_node;
         for (auto const& node : nodes_list) {
             if (!does_node_exist(node)) {
-                add_node(node.label);
+                add_node(node_label(node));
             }
             if (current_node > 0) {
                 add_edge(previous_node, node);
@@ -140,11 +650,11 @@ class Graph {
     // Add a cycle given a list of labels representing nodes
     void add_cycle(const std::list<std::string>& labels_list) {
         if (labels_list.size() > 0) {
-            int current_label = 0;
+            NodeId current_label = 0;
             std::string previous_label;
             std::string first_label;
             for (auto const& label : labels_list) {
-                if (labels.find(label) == labels.end()) {
+                if (find(label) < 0) {
                     // Label does not exist, add node with label
                     add_node(label);
                 }
@@ -163,12 +673,12 @@ class Graph {
     // Add a cycle given a list of nodes
     void add_cycle(const std::list<Node>& nodes_list) {
         if (nodes_list.size() > 0) {
-            int current_node = 0;
+            NodeId current_node = 0;
             Node previous_node;
             Node first_node;
             for (auto const& node : nodes_list) {
                 if (!does_node_exist(node)) {
-                    add_node(node.label);
+                    add_node(node_label(node));
                 }
                 if (current_node > 0) {
                     add_edge(previous_node, node);
@@ -183,43 +693,61 @@ class Graph {
     }
 
     // Add a balanced tree
-    void add_balanced_tree(int children, int height) {
-        int initial_size = graph.size();
+    void add_balanced_tree(NodeId children, int height) {
+        NodeId initial_size = graph.size();
         // Calculate number of nodes in tree
-        int node_amount;
+        NodeId node_amount;
         if (height == 0) {
             add_node();
         } else if (children == 1) {
-            node_amount = height + 1;
-            for (int i = initial_size; i < (initial_size + node_amount); i++) {
+            if (height >= std::numeric_limits<NodeId>::max()) {
+                throw std::overflow_error("Balanced tree has too many nodes");
+            }
+            node_amount = (NodeId)(height) + 1;
+            for (NodeId i = initial_size; i < (initial_size + node_amount);
+                 i++) {
                 if (i > initial_size) {
                     add_edge(std::to_string(i - 1), std::to_string(i));
                 }
             }
         } else {
-            // Formula for the sum of a geometric sequence
-            node_amount =
-                (int)((1 - pow(children, height + 1)) / (1 - children));
+            // Sum of the geometric sequence 1 + children + ... +
+            // children^height, in integers to stay exact for large trees
+            const NodeId max_nodes = std::numeric_limits<NodeId>::max();
+            node_amount = 1;
+            NodeId level_size = 1;
+            for (int depth = 1; depth <= height; depth++) {
+                if (level_size > max_nodes / children) {
+                    throw std::overflow_error(
+                        "Balanced tree has too many nodes");
+                }
+                level_size *= children;
+                if (node_amount > max_nodes - level_size) {
+                    throw std::overflow_error(
+                        "Balanced tree has too many nodes");
+                }
+                node_amount += level_size;
+            }
             add_full_mary_tree(children, node_amount);
         }
     }
 
     // Add a barbell graph
-    void add_barbell(int m1, int m2) {
+    void add_barbell(NodeId m1, NodeId m2) {
         if (m1 < 2) {
             throw GraphwError("Invalid graph properties, m1 should be >=2");
         }
         if (m2 < 0) {
             throw GraphwError("Invalid graph properties, m2 should be >=0");
         }
-        int initial_size;
+        NodeId initial_size;
         // Create first clique
         add_complete(m1);
         if (m2 > 0) {
             // Update initial size
             initial_size = graph.size();
             std::list<std::string> path_nodes;
-            for (int i = initial_size; i < (initial_size + m2); i++) {
+            for (NodeId i = initial_size; i < (initial_size + m2); i++) {
                 path_nodes.push_back(std::to_string(i));
             }
             add_path(path_nodes);
@@ -242,22 +770,22 @@ class Graph {
             // If order is less than 1, add a single node
             add_node();
         } else {
-            int initial_size = graph.size();
+            NodeId initial_size = graph.size();
             // Edge represents two node ids
             struct Edge {
-                int id1;
-                int id2;
+                NodeId id1;
+                NodeId id2;
             };
             // edges_vector holds the edges in the current binomial tree
             std::vector<Edge> edges_vector;
-            int n = 1;
-            for (int i = initial_size; i < (initial_size + order); i++) {
+            NodeId n = 1;
+            for (NodeId i = initial_size; i < (initial_size + order); i++) {
                 // Capture current edges_vector size
-                int initial_edges_size = edges_vector.size();
-                for (int j = initial_size;
+                NodeId initial_edges_size = edges_vector.size();
+                for (NodeId j = initial_size;
                      j < (initial_size + initial_edges_size); j++) {
-                    int u = edges_vector[j - initial_size].id1 + n;
-                    int v = edges_vector[j - initial_size].id2 + n;
+                    NodeId u = edges_vector[j - initial_size].id1 + n;
+                    NodeId v = edges_vector[j - initial_size].id2 + n;
                     add_edge(std::to_string(u), std::to_string(v));
                     edges_vector.push_back({u, v});
                 }
@@ -269,7 +797,7 @@ class Graph {
     }
 
     // Add a complete graph
-    void add_complete(int n) {
+    void add_complete(NodeId n) {
         if (n < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(n));
@@ -278,9 +806,9 @@ class Graph {
             if (n == 1) {
                 add_node();
             } else {
-                int initial_size = graph.size();
-                for (int i = initial_size; i < (initial_size + n); i++) {
-                    for (int j = (i + 1); j < (initial_size + n); j++) {
+                NodeId initial_size = graph.size();
+                for (NodeId i = initial_size; i < (initial_size + n); i++) {
+                    for (NodeId j = (i + 1); j < (initial_size + n); j++) {
                         add_edge(std::to_string(i), std::to_string(j));
                     }
                 }
@@ -289,12 +817,12 @@ class Graph {
     }
 
     // Add a complete multipartite graph
-    void add_complete_multipartite(const std::list<int>& subset_sizes) {
-        int initial_size = graph.size();
+    void add_complete_multipartite(const std::list<NodeId>& subset_sizes) {
+        NodeId initial_size = graph.size();
         // sizes_vector is vector format of subset_sizes list for operator[]
-        std::vector<int> sizes_vector;
+        std::vector<NodeId> sizes_vector;
         // Calculate amount of nodes
-        int node_amount = 0;
+        NodeId node_amount = 0;
         for (auto const& size : subset_sizes) {
             if (size > 0) {
                 node_amount += size;
@@ -306,14 +834,14 @@ class Graph {
             // Ignore if size is 0
         }
         // Add initial nodes to preserve node ordering
-        for (int i = initial_size; i < (initial_size + node_amount); i++) {
+        for (NodeId i = initial_size; i < (initial_size + node_amount); i++) {
             add_node(std::to_string(i));
         }
         // Add edges
-        int current_subset = 0;
-        int subset_counter = 0;
-        int first_neighbor;
-        for (int i = initial_size; i < (initial_size + node_amount); i++) {
+        NodeId current_subset = 0;
+        NodeId subset_counter = 0;
+        NodeId first_neighbor;
+        for (NodeId i = initial_size; i < (initial_size + node_amount); i++) {
             if (subset_counter >= sizes_vector[current_subset]) {
                 current_subset++;
                 subset_counter = 0;
@@ -326,8 +854,8 @@ class Graph {
                     // First node in subset
                     first_neighbor = i + sizes_vector[current_subset];
                 }
-                for (int j = first_neighbor; j < (initial_size + node_amount);
-                     j++) {
+                for (NodeId j = first_neighbor;
+                     j < (initial_size + node_amount); j++) {
                     add_edge(std::to_string(i), std::to_string(j));
                 }
             }
@@ -336,12 +864,12 @@ class Graph {
     }
 
     // Add a circular ladder graph
-    void add_circular_ladder(int n) {
+    void add_circular_ladder(NodeId n) {
         if (n < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(n));
         } else if (n > 0) {
-            int initial_size = graph.size();
+            NodeId initial_size = graph.size();
             add_ladder(n);
             if (n > 2) {
                 add_edge(std::to_string(initial_size),
@@ -353,16 +881,16 @@ class Graph {
     }
 
     // Add a circulant graph
-    void add_circulant(int n, const std::list<int>& offsets) {
+    void add_circulant(NodeId n, const std::list<NodeId>& offsets) {
         if (n < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(n));
         } else if (n > 0) {
-            int initial_size = graph.size();
+            NodeId initial_size = graph.size();
             // Add nodes
             add_empty(n);
             // Add edges
-            for (int i = initial_size; i < (initial_size + n); i++) {
+            for (NodeId i = initial_size; i < (initial_size + n); i++) {
                 for (auto const& offset : offsets) {
                     add_edge(std::to_string(i),
                              std::to_string((i + abs(offset)) % n));
@@ -372,20 +900,20 @@ class Graph {
     }
 
     // Add an empty graph
-    void add_empty(int n) {
+    void add_empty(NodeId n) {
         if (n < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(n));
         }
-        int initial_size = graph.size();
+        NodeId initial_size = graph.size();
         // Add nodes
-        for (int i = initial_size; i < (initial_size + n); i++) {
+        for (NodeId i = initial_size; i < (initial_size + n); i++) {
             add_node(std::to_string(i));
         }
     }
 
     // Add a full m-ary tree
-    void add_full_mary_tree(int m, int n) {
+    void add_full_mary_tree(NodeId m, NodeId n) {
         if (n < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(n));
@@ -393,11 +921,11 @@ class Graph {
         if (m == 0) {
             add_empty(n);
         } else {
-            int initial_size = graph.size();
-            int current_node = initial_size;
-            for (int i = initial_size;
+            NodeId initial_size = graph.size();
+            NodeId current_node = initial_size;
+            for (NodeId i = initial_size;
                  (i < (initial_size + n)) && (current_node < n); i++) {
-                for (int j = 1; (j <= m) && ((current_node + j) < n); j++) {
+                for (NodeId j = 1; (j <= m) && ((current_node + j) < n); j++) {
                     // Add edge
                     add_edge(std::to_string(i),
                              std::to_string(current_node + j));
@@ -408,23 +936,23 @@ class Graph {
     }
 
     // Add a ladder graph
-    void add_ladder(int n) {
+    void add_ladder(NodeId n) {
         if (n < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(n));
         } else if (n > 0) {
-            int initial_size = graph.size();
+            NodeId initial_size = graph.size();
             // Add nodes
             add_empty(2 * n);
             // Add edges
-            for (int i = initial_size; i < (initial_size + n); i++) {
+            for (NodeId i = initial_size; i < (initial_size + n); i++) {
                 if (i > initial_size) {
                     add_edge(std::to_string(i - 1), std::to_string(i));
                 }
                 // Add edge rung
                 add_edge(std::to_string(i), std::to_string(i + n));
             }
-            for (int i = (initial_size + n); i < (initial_size + (2 * n));
+            for (NodeId i = (initial_size + n); i < (initial_size + (2 * n));
                  i++) {
                 if (i > (initial_size + n)) {
                     add_edge(std::to_string(i - 1), std::to_string(i));
@@ -434,14 +962,14 @@ class Graph {
     }
 
     // Add a lollipop graph
-    void add_lollipop(int m, int n) {
+    void add_lollipop(NodeId m, NodeId n) {
         if (m < 2) {
             throw GraphwError("Invalid graph properties, m should be >=2");
         }
         if (n < 0) {
             throw GraphwError("Invalid graph properties, n should be >=0");
         }
-        int initial_size = graph.size();
+        NodeId initial_size = graph.size();
         // Create clique
         add_complete(m);
         if (n > 0) {
@@ -449,7 +977,7 @@ class Graph {
             add_edge(std::to_string((initial_size + m) - 1),
                      std::to_string(initial_size + m));
             std::list<std::string> path_nodes;
-            for (int i = m; i < (m + n); i++) {
+            for (NodeId i = m; i < (m + n); i++) {
                 path_nodes.push_back(std::to_string(i));
             }
             // Add path segment
@@ -458,7 +986,7 @@ class Graph {
     }
 
     // Add a star graph
-    void add_star(int k) {
+    void add_star(NodeId k) {
         if (k < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(k));
@@ -466,31 +994,32 @@ class Graph {
             // If k is 0, simply add a node
             add_node();
         } else {
-            int initial_size = graph.size();
+            NodeId initial_size = graph.size();
             // Add nodes
-            for (int i = (initial_size + 1); i < (initial_size + k + 1); i++) {
+            for (NodeId i = (initial_size + 1); i < (initial_size + k + 1);
+                 i++) {
                 add_edge(std::to_string(initial_size), std::to_string(i));
             }
         }
     }
 
     // Add a Turan graph
-    void add_turan(int n, int r) {
+    void add_turan(NodeId n, NodeId r) {
         if (r < 1 || r > n) {
             throw GraphwError("r must satisfy the condition 1 <= r <= n");
         }
         // Calculate subset sizes
-        int subset1_size = r - (n % r);
-        int subset2_size = n % r;
+        NodeId subset1_size = r - (n % r);
+        NodeId subset2_size = n % r;
         // Calculate subset values
-        int subset1_value = (int)(floor(n / r));
-        int subset2_value = (int)(floor(n / r) + 1);
+        NodeId subset1_value = (NodeId)(floor(n / r));
+        NodeId subset2_value = (NodeId)(floor(n / r) + 1);
         // Add subset values to subset_sizes_list
-        std::list<int> subset_sizes_list;
-        for (int i = 0; i < subset1_size; i++) {
+        std::list<NodeId> subset_sizes_list;
+        for (NodeId i = 0; i < subset1_size; i++) {
             subset_sizes_list.push_back(subset1_value);
         }
-        for (int i = 0; i < subset2_size; i++) {
+        for (NodeId i = 0; i < subset2_size; i++) {
             subset_sizes_list.push_back(subset2_value);
         }
         // Add subset_sizes_list to create complete multipartite graph
@@ -498,19 +1027,19 @@ class Graph {
     }
 
     // Add a wheel graph
-    void add_wheel(int n) {
+    void add_wheel(NodeId n) {
         if (n < 0) {
             throw GraphwError("Negative number of nodes not valid: " +
                               std::to_string(n));
         }
         if (n != 0) {
-            int initial_size = graph.size();
+            NodeId initial_size = graph.size();
             // To construct wheel graph, first construct a star graph
             add_star(n - 1);
             if (n > 2) {
                 // If there are at least 2 nodes, create additional edges
                 // Create cycle between nodes
-                for (int i = initial_size; i < (initial_size + n); i++) {
+                for (NodeId i = initial_size; i < (initial_size + n); i++) {
                     if (i > initial_size) {
                         add_edge(std::to_string(i - 1), std::to_string(i));
                     }
@@ -524,78 +1053,241 @@ class Graph {
     }
 
     // Return the adjacency list of the graph with labels representing each node
-    std::string get_adjacency_list(const std::string& delimiter = " ") {
+    std::string get_adjacency_list(const std::string& delimiter = " ") const {
         std::string adjacency_list;
-        // Fill adjacency list
-        for (int i = 0; i < graph.size(); i++) {
-            std::string line;
-            line += labels_vector[i] + delimiter;
-            for (int j = 0; j < graph[i].size(); j++) {
-                // Add neighbors to line
-                line += graph[i][j].label + delimiter;
-            }
-            adjacency_list += line + '\n';
-            line.clear();
-        }
+        write_adjacency_list_to(
+            [&adjacency_list](const char* data, size_t size) {
+                adjacency_list.append(data, size);
+            },
+            delimiter, false);
         return adjacency_list;
     }
 
+    // Write the adjacency list to a stream through a bounded buffer. If
+    // parallel is set, ranges of rows are formatted by multiple threads and
+    // written in order.
+    void write_adjacency_list(std::ostream& stream,
+                              const std::string& delimiter = " ",
+                              bool parallel = false) const {
+        write_adjacency_list_to(
+            [&stream](const char* data, size_t size) {
+                if (!stream.write(data, (std::streamsize)(size))) {
+                    throw GraphwError("Could not write adjacency list");
+                }
+            },
+            delimiter, parallel);
+    }
+
+    // Write the adjacency list to a file descriptor through a bounded buffer
+    void write_adjacency_list(int fd, const std::string& delimiter = " ",
+                              bool parallel = false) const {
+        write_adjacency_list_to(
+            [fd](const char* data, size_t size) {
+                detail::write_all(fd, data, size);
+            },
+            delimiter, parallel);
+    }
+
+    // Load edges from a file where each line holds two node labels separated
+    // by whitespace. Lines starting with '#' or '%' are comments and lines with
+    // a single label add an isolated node. Unlike add_edge, duplicate edges in
+    // the file are not filtered out.
+    void load_edge_list(const std::string& path) {
+        detail::MappedFile file(path);
+        typedef std::vector<std::pair<std::string_view, std::string_view> >
+            Pairs;
+        detail::parse_lines<Pairs>(
+            file.data(), file.size(),
+            [](const char* it, const char* end, Pairs& pairs) {
+                while (it < end) {
+                    const char* line_end =
+                        static_cast<const char*>(memchr(it, '\n', end - it));
+                    if (line_end == nullptr) {
+                        line_end = end;
+                    }
+                    std::string_view tokens[2];
+                    int count = 0;
+                    while (count < 2) {
+                        while (it < line_end && detail::is_blank(*it)) {
+                            it++;
+                        }
+                        if (it == line_end ||
+                            (count == 0 && (*it == '#' || *it == '%'))) {
+                            break;
+                        }
+                        const char* token = it;
+                        while (it < line_end && !detail::is_blank(*it)) {
+                            it++;
+                        }
+                        tokens[count++] = std::string_view(token, it - token);
+                    }
+                    if (count > 0) {
+                        pairs.emplace_back(tokens[0], tokens[1]);
+                    }
+                    it = line_end + 1;
+                }
+            },
+            [this](const Pairs& pairs) {
+                // Insert in file order so node ids are deterministic
+                for (auto const& pair : pairs) {
+                    NodeId id1 = intern(pair.first);
+                    if (!pair.second.empty()) {
+                        append_edge(id1, intern(pair.second), EdgePayload());
+                    }
+                }
+            });
+        check_density();
+    }
+
+    // Load nodes and edges from a file in the format returned by
+    // get_adjacency_list with the same delimiter. Neighbor order is kept, so
+    // loading into an empty graph reproduces the original adjacency list.
+    void load_adjacency_list(const std::string& path,
+                             const std::string& delimiter = " ") {
+        if (delimiter.empty()) {
+            throw GraphwError("Delimiter must not be empty");
+        }
+        detail::MappedFile file(path);
+        // Labels of each line in order, ends marks one past each line's last
+        struct Lines {
+            std::vector<std::string_view> tokens;
+            std::vector<size_t> ends;
+
+            void clear() {
+                tokens.clear();
+                ends.clear();
+            }
+        };
+        auto parse = [&delimiter](const char* it, const char* end,
+                                  Lines& lines, bool heads_only) {
+            std::string_view view(it, end - it);
+            size_t position = 0;
+            while (position < view.size()) {
+                size_t line_end = view.find('\n', position);
+                if (line_end == std::string_view::npos) {
+                    line_end = view.size();
+                }
+                std::string_view line =
+                    view.substr(position, line_end - position);
+                size_t token_start = 0;
+                while (token_start < line.size()) {
+                    size_t token_end = line.find(delimiter, token_start);
+                    if (token_end == std::string_view::npos) {
+                        token_end = line.size();
+                    }
+                    if (token_end > token_start) {
+                        lines.tokens.push_back(
+                            line.substr(token_start, token_end - token_start));
+                        if (heads_only) {
+                            break;
+                        }
+                    }
+                    token_start = token_end + delimiter.size();
+                }
+                if (lines.tokens.size() >
+                    (lines.ends.empty() ? 0 : lines.ends.back())) {
+                    lines.ends.push_back(lines.tokens.size());
+                }
+                position = line_end + 1;
+            }
+        };
+        // First pass adds the node of every line so ids follow line order
+        detail::parse_lines<Lines>(
+            file.data(), file.size(),
+            [&parse](const char* it, const char* end, Lines& lines) {
+                parse(it, end, lines, true);
+            },
+            [this](const Lines& lines) {
+                for (auto const& label : lines.tokens) {
+                    intern(label);
+                }
+            });
+        // Second pass appends the neighbors
+        size_t entries = 0;
+        detail::parse_lines<Lines>(
+            file.data(), file.size(),
+            [&parse](const char* it, const char* end, Lines& lines) {
+                parse(it, end, lines, false);
+            },
+            [this, &entries](const Lines& lines) {
+                size_t start = 0;
+                for (size_t line_end : lines.ends) {
+                    NodeId id = intern(lines.tokens[start]);
+                    for (size_t i = start + 1; i < line_end; i++) {
+                        NodeId neighbor_id = intern(lines.tokens[i]);
+                        link(id, entry(neighbor_id, EdgePayload()));
+                    }
+                    entries += line_end - start - 1;
+                    start = line_end;
+                }
+            });
+        // Undirected edges are listed once for each of their nodes
+        edges += (EdgeCount)(directed() ? entries : entries / 2);
+        check_density();
+    }
+
     // Return the density of the graph
     float density() const {
         float size = (float)(graph.size());
-        if (directed_) {
+        if (directed()) {
             return (float)(edges / (size * (size - 1)));
         }
         return (float)((2 * edges) / (size * (size - 1)));
     }
 
     // Return the degree of a node with given label
-    int degree(std::string label) {
-        if (labels.find(label) == labels.end()) {
-            // Label does not exist
-            throw GraphwError("Given label does not exist");
-        }
-        int node_id = identities[label];
-        return graph[node_id].size();
+    EdgeCount degree(const std::string& label) const {
+        return graph[existing_id(label)].size();
     }
 
     // Return the average degree of the graph
-    float average_degree() {
-        int total = 0;
-        for (int i = 0; i < graph.size(); i++) {
-            total += degree(labels_vector[i]);
+    float average_degree() const {
+        EdgeCount total = 0;
+        for (NodeId i = 0; i < graph.size(); i++) {
+            total += graph[i].size();
         }
         return ((float)total / (float)graph.size());
     }
 
     // Return a list of labels representing the neighbor of a given node label
-    std::list<std::string> get_neighbors(std::string label) {
-        if (labels.find(label) == labels.end()) {
-            // Label does not exist
-            throw GraphwError("Given label does not exist");
-        }
-        int node_id = identities[label];
+    std::list<std::string> get_neighbors(const std::string& label) const {
+        NodeId node_id = existing_id(label);
         std::list<std::string> neighbors;
-        for (int i = 0; i < graph[node_id].size(); i++) {
-            neighbors.push_back(graph[node_id][i].label);
+        for (NodeId i = 0; i < graph[node_id].size(); i++) {
+            neighbors.push_back(this->label(graph[node_id][i].id));
         }
         return neighbors;
     }
 
     // Return a list of labels representing the non-neighbors of a given node
     // label
-    std::list<std::string> get_non_neighbors(std::string label) {
-        if (labels.find(label) == labels.end()) {
-            // Label does not exist
-            throw GraphwError("Given label does not exist");
+    std::list<std::string> get_non_neighbors(const std::string& label) const {
+        if (dense_) {
+            // Complement the row of the node a word at a time
+            NodeId node_id = existing_id(label);
+            std::list<std::string> non_neighbors;
+            for (size_t word = 0; word < stride; word++) {
+                uint64_t bits = ~matrix[(node_id * stride) + word];
+                while (bits != 0) {
+                    size_t i = (word * 64) + __builtin_ctzll(bits);
+                    if (i >= graph.size()) {
+                        break;
+                    }
+                    if (i != (size_t)(node_id)) {
+                        non_neighbors.push_back(this->label((NodeId)(i)));
+                    }
+                    bits &= bits - 1;
+                }
+            }
+            return non_neighbors;
         }
         // Neighbors of the given node label
         std::list<std::string> neighbors = get_neighbors(label);
         // List which will hold all non neighbors
         std::list<std::string> non_neighbors;
-        for (int i = 0; i < graph.size(); i++) {
+        for (NodeId i = 0; i < graph.size(); i++) {
             bool is_neighbor = false;
-            std::string current_label = labels_vector[i];
+            std::string current_label = this->label(i);
             if (current_label != label) {
                 // Current label being compared is not equal to given label
                 is_neighbor =
@@ -618,96 +1310,592 @@ class Graph {
 
     // Return a list of labels representing the common neighbor(s) given two
     // node labels
-    std::list<std::string> get_common_neighbors(std::string label1,
-                                                std::string label2) {
-        if (labels.find(label1) == labels.end() ||
-            labels.find(label2) == labels.end()) {
-            // At least one of the labels do not exist
-            throw GraphwError("Given label does not exist");
+    std::list<std::string> get_common_neighbors(
+        const std::string& label1, const std::string& label2) const {
+        if (dense_) {
+            // Check the neighbors of label1 against the row of label2, which
+            // keeps their order and any repeated neighbors like the lists
+            NodeId node2_id = existing_id(label2);
+            std::list<std::string> common_neighbors;
+            for (auto const& neighbor : graph[existing_id(label1)]) {
+                if (matrix_bit(node2_id, neighbor.id)) {
+                    common_neighbors.push_back(label(neighbor.id));
+                }
+            }
+            return common_neighbors;
         }
         // List of label1's neighbors
         std::list<std::string> neighbors1 = get_neighbors(label1);
         // List of label2's neighbors
         std::list<std::string> neighbors2 = get_neighbors(label2);
-        // Compare lists
-        std::list<std::string> common_neighbors(
-            std::min(neighbors1.size(), neighbors2.size()));
-        auto it = std::copy_if(
-            neighbors1.begin(), neighbors1.end(), common_neighbors.begin(),
+        // Compare lists, appending so repeated neighbors of label1 cannot
+        // overrun the result
+        std::list<std::string> common_neighbors;
+        std::copy_if(
+            neighbors1.begin(), neighbors1.end(),
+            std::back_inserter(common_neighbors),
             [neighbors2](const std::string& label_a) {
                 return std::any_of(neighbors2.begin(), neighbors2.end(),
                                    [label_a](const std::string& label_b) {
                                        return label_a == label_b;
                                    });
             });
-        common_neighbors.resize(std::distance(common_neighbors.begin(), it));
         return common_neighbors;
     }
 
+    // Return the number of edges from a node with given label, which is its
+    // degree
+    EdgeCount out_degree(const std::string& label) const {
+        return graph[existing_id(label)].size();
+    }
+
+    // Return the number of edges to a node with given label. Scans every edge
+    // unless the in-edge index is enabled.
+    EdgeCount in_degree(const std::string& label) const {
+        NodeId node_id = existing_id(label);
+        if (in_edge_index_) {
+            return in_edges[node_id].size();
+        }
+        EdgeCount count = 0;
+        for (auto const& neighbors : graph) {
+            for (auto const& neighbor : neighbors) {
+                count += neighbor.id == node_id;
+            }
+        }
+        return count;
+    }
+
+    // Return a list of labels representing the nodes with an edge to a given
+    // node label. Scans every edge unless the in-edge index is enabled.
+    std::list<std::string> in_neighbors(const std::string& label) const {
+        NodeId node_id = existing_id(label);
+        std::list<std::string> neighbors;
+        if (in_edge_index_) {
+            for (NodeId neighbor_id : in_edges[node_id]) {
+                neighbors.push_back(this->label(neighbor_id));
+            }
+            return neighbors;
+        }
+        for (size_t i = 0; i < graph.size(); i++) {
+            for (auto const& neighbor : graph[i]) {
+                if (neighbor.id == node_id) {
+                    neighbors.push_back(this->label((NodeId)(i)));
+                }
+            }
+        }
+        return neighbors;
+    }
+
+    // Return a list of labels representing the predecessors of a given node
+    // label, which are its in-neighbors
+    inline std::list<std::string> predecessors(const std::string& label) const {
+        return in_neighbors(label);
+    }
+
+    // Enable or disable the in-edge index, which keeps the in-neighbors of
+    // every node so that in_degree and in_neighbors do not scan every edge.
+    // The index is kept up to date by methods which add nodes and edges, but
+    // not by direct changes to graph.
+    void set_in_edge_index(bool enabled) {
+        in_edge_index_ = enabled;
+        std::vector<std::vector<NodeId> >().swap(in_edges);
+        if (enabled) {
+            in_edges.resize(graph.size());
+            for (size_t i = 0; i < graph.size(); i++) {
+                for (auto const& neighbor : graph[i]) {
+                    in_edges[neighbor.id].push_back((NodeId)(i));
+                }
+            }
+        }
+    }
+
+    // Return whether the in-edge index is enabled
+    inline bool in_edge_index() const { return in_edge_index_; }
+
+    // Return whether there is an edge from the node with label1 to the node
+    // with label2
+    bool has_edge(const std::string& label1, const std::string& label2) const {
+        return linked(existing_id(label1), existing_id(label2));
+    }
+
+    // Enable or disable the adjacency matrix, an opt-in edge lookup index
+    // which is kept next to the adjacency lists as one bit per pair of nodes,
+    // so it adds to the memory of the graph. Checking for an edge then takes
+    // constant time, which makes adding edges to dense graphs much faster.
+    // The matrix is kept up to date like the in-edge index. Stops the matrix
+    // from being switched automatically until set_dense_threshold is called.
+    void set_dense(bool enabled) {
+        dense_automatic_ = false;
+        switch_matrix(enabled);
+    }
+
+    // Return whether the adjacency matrix is enabled
+    inline bool dense() const { return dense_; }
+
+    // Set the density at which the adjacency matrix is enabled automatically
+    // when edges are added to a graph with at least 64 nodes, which turns on
+    // automatic switching. It is disabled again once the density falls below
+    // half of the threshold. A threshold above 1 never enables it.
+    inline void set_dense_threshold(float new_dense_threshold_) {
+        dense_threshold_ = new_dense_threshold_;
+        dense_automatic_ = true;
+    }
+
+    // Return the density at which the adjacency matrix is enabled
+    inline float dense_threshold() const { return dense_threshold_; }
+
+    // Set a numeric attribute of the node with given label, nodes which
+    // have not been given a value for the attribute have the value 0
+    void set_attribute(const std::string& name, const std::string& label,
+                       double value) {
+        NodeId node_id = existing_id(label);
+        std::vector<double>& column = attributes[name];
+        column.resize(graph.size(), 0.0);
+        column[node_id] = value;
+    }
+
+    // Return a numeric attribute of the node with given label
+    double attribute(const std::string& name, const std::string& label) const {
+        return attribute_column(name)[existing_id(label)];
+    }
+
+    // Return the values of an attribute indexed by node id
+    const std::vector<double>& attribute_column(const std::string& name) const {
+        auto it = attributes.find(name);
+        if (it == attributes.end()) {
+            throw GraphwError("Given attribute does not exist");
+        }
+        return it->second;
+    }
+
+    // Return the names of the attributes in the graph
+    std::vector<std::string> attribute_names() const {
+        std::vector<std::string> names;
+        for (auto const& column : attributes) {
+            names.push_back(column.first);
+        }
+        return names;
+    }
+
     // Remove all nodes and edges from the graph
     void clear() {
+        version_++;
         graph.clear();
-        labels.clear();
+        in_edges.clear();
+        matrix.clear();
+        stride = 0;
         labels_vector.clear();
         identities.clear();
+        attributes.clear();
         edges = 0;
     }
 
     // Return whether graph is directed
-    inline bool directed() const { return directed_; }
+    inline bool directed() const {
+        if constexpr (std::is_same<DirectionPolicy, RuntimeDirected>::value) {
+            return directed_;
+        } else {
+            return std::is_same<DirectionPolicy, Directed>::value;
+        }
+    }
 
-    // Set the graph to be directed or not
-    inline void set_directed(bool new_directed_) { directed_ = new_directed_; }
+    // Set the graph to be directed or not, which is only possible if the
+    // direction is chosen at runtime
+    inline void set_directed(bool new_directed_) {
+        check_direction(new_directed_);
+        if (new_directed_ != directed_) {
+            version_++;
+        }
+        directed_ = new_directed_;
+    }
 
     // Return number of nodes
-    inline int number_of_nodes() const { return (int)(graph.size()); }
+    inline NodeId number_of_nodes() const { return (NodeId)(graph.size()); }
+
+    // Return the structural version of the graph, which grows by one for
+    // every node added and every entry added to an adjacency list, and on
+    // any other change to nodes, edges, ids or direction. Results derived
+    // from the graph can be cached along with it.
+    inline uint64_t version() const { return version_; }
 
     // Return number of edges
-    inline int number_of_edges() const { return edges; }
+    inline EdgeCount number_of_edges() const { return edges; }
+
+    // Return the label of the node with given id
+    inline Label label(NodeId id) const {
+        if constexpr (labelled) {
+            return labels_vector[id];
+        } else {
+            return std::to_string(id);
+        }
+    }
+
+    // Return the id of the node with given label
+    inline NodeId id(const std::string& label) const {
+        return existing_id(label);
+    }
+
+    // Renumber nodes with given ordering, moving their adjacency lists and
+    // attributes along with them. Returns the old id of each node indexed by
+    // its new id. With integer labels nodes are relabelled by their new id.
+    std::vector<NodeId> reorder(Ordering ordering) {
+        // Orderings work on neighbors in both directions
+        std::vector<std::vector<NodeId> > adjacency(graph.size());
+        for (size_t i = 0; i < graph.size(); i++) {
+            for (auto const& neighbor : graph[i]) {
+                adjacency[i].push_back(neighbor.id);
+                if (directed()) {
+                    adjacency[neighbor.id].push_back((NodeId)(i));
+                }
+            }
+        }
+        std::vector<NodeId> order;
+        switch (ordering) {
+            case Ordering::reverse_cuthill_mckee:
+                order = detail::reverse_cuthill_mckee_order(adjacency);
+                break;
+            case Ordering::degree:
+                order = detail::degree_order(adjacency);
+                break;
+            case Ordering::hub_cluster:
+                order = detail::hub_cluster_order(adjacency);
+                break;
+            case Ordering::gorder:
+                order = detail::gorder_order(adjacency);
+                break;
+        }
+        permute(order);
+        return order;
+    }
 
    private:
-    std::set<std::string> labels;
+    friend class ConcurrentGraphBuilder;
+    friend class GraphView;
+
+    static constexpr bool labelled =
+        std::is_same<LabelPolicy, StringLabels>::value;
+
+    // Label table, empty with integer labels
     std::vector<std::string> labels_vector;
-    std::unordered_map<std::string, int> identities;
-    int edges;
+    std::unordered_map<std::string, NodeId> identities;
+    std::map<std::string, std::vector<double> > attributes;
+    EdgeCount edges;
     bool directed_;
+    // Ids of the nodes listing each node as a neighbor, only kept if
+    // in_edge_index_ is set
+    std::vector<std::vector<NodeId> > in_edges;
+    bool in_edge_index_;
+    uint64_t version_;
+    // Bit-packed adjacency matrix with stride words per row, only kept if
+    // dense_ is set. Bit j of row i is set if node j is a neighbor of node i.
+    std::vector<uint64_t> matrix;
+    size_t stride;
+    bool dense_;
+    // Whether the matrix is switched on and off by density
+    bool dense_automatic_;
+    float dense_threshold_;
+
+    // Append neighbor to the adjacency list of node id, updating the in-edge
+    // index
+    inline void link(NodeId id, const Node& neighbor) {
+        version_++;
+        graph[id].push_back(neighbor);
+        if (in_edge_index_) {
+            in_edges[neighbor.id].push_back(id);
+        }
+        if (dense_) {
+            matrix[(id * stride) + (neighbor.id >> 6)] |= (uint64_t)(1)
+                                                         << (neighbor.id & 63);
+        }
+    }
 
-    // Return a node struct instance given
-    // a string label
-    inline Node get_node(std::string label) const {
-        return {(int)(graph.size()), label};
+    // Return whether the adjacency matrix has the edge from node id1 to node
+    // id2
+    inline bool matrix_bit(NodeId id1, NodeId id2) const {
+        return (matrix[(id1 * stride) + (id2 >> 6)] >> (id2 & 63)) & 1;
+    }
+
+    // Return whether node id2 is in the adjacency list of node id1
+    inline bool linked(NodeId id1, NodeId id2) const {
+        if (dense_) {
+            return matrix_bit(id1, id2);
+        }
+        return std::any_of(graph[id1].begin(), graph[id1].end(),
+                           [id2](const Node& node) { return node.id == id2; });
+    }
+
+    // Add rows to the adjacency matrix for new nodes, widening every row if
+    // it has no room for the new columns
+    void grow_matrix() {
+        size_t nodes = graph.size();
+        if (nodes > stride * 64) {
+            size_t new_stride = std::max(stride * 2, (nodes + 63) / 64);
+            std::vector<uint64_t> new_matrix(nodes * new_stride, 0);
+            size_t rows = stride > 0 ? matrix.size() / stride : 0;
+            for (size_t i = 0; i < rows; i++) {
+                std::copy(matrix.begin() + (i * stride),
+                          matrix.begin() + ((i + 1) * stride),
+                          new_matrix.begin() + (i * new_stride));
+            }
+            matrix = std::move(new_matrix);
+            stride = new_stride;
+        }
+        matrix.resize(nodes * stride, 0);
+    }
+
+    // Build or drop the adjacency matrix
+    void switch_matrix(bool enabled) {
+        dense_ = enabled;
+        std::vector<uint64_t>().swap(matrix);
+        stride = 0;
+        if (enabled) {
+            grow_matrix();
+            for (size_t i = 0; i < graph.size(); i++) {
+                for (auto const& neighbor : graph[i]) {
+                    matrix[(i * stride) + (neighbor.id >> 6)] |=
+                        (uint64_t)(1) << (neighbor.id & 63);
+                }
+            }
+        }
+    }
+
+    // Switch to the adjacency matrix once the density reaches the threshold
+    // and back once it falls below half of it
+    inline void check_density() {
+        if (!dense_automatic_ || graph.size() < 64) {
+            return;
+        }
+        float current = density();
+        if (!dense_ && current >= dense_threshold_) {
+            switch_matrix(true);
+        } else if (dense_ && current < dense_threshold_ / 2) {
+            switch_matrix(false);
+        }
+    }
+
+    // Throw if the graph cannot have given direction
+    inline void check_direction(bool new_directed_) const {
+        if (!std::is_same<DirectionPolicy, RuntimeDirected>::value &&
+            new_directed_ != std::is_same<DirectionPolicy, Directed>::value) {
+            throw GraphwError("Direction of the graph is fixed by its type");
+        }
+    }
+
+    // Return the id given by an integer label, throwing if it is not a
+    // non-negative integer without leading zeros
+    static NodeId parse_id(std::string_view label) {
+        NodeId id = -1;
+        auto result =
+            std::from_chars(label.data(), label.data() + label.size(), id);
+        if (result.ec != std::errc() ||
+            result.ptr != label.data() + label.size() || id < 0 ||
+            (label.size() > 1 && label[0] == '0')) {
+            throw GraphwError("Label is not a node id: " +
+                              std::string(label));
+        }
+        return id;
+    }
+
+    // Return the id of the node with given label or -1 if it does not exist
+    NodeId find(const std::string& label) const {
+        if constexpr (labelled) {
+            auto it = identities.find(label);
+            return it == identities.end() ? -1 : it->second;
+        } else {
+            NodeId id = -1;
+            auto result =
+                std::from_chars(label.data(), label.data() + label.size(), id);
+            if (result.ec != std::errc() ||
+                result.ptr != label.data() + label.size() ||
+                (label.size() > 1 && label[0] == '0') ||
+                id >= (NodeId)(graph.size())) {
+                return -1;
+            }
+            return id;
+        }
+    }
+
+    // Return the id of the node with given label, throwing if it does not
+    // exist
+    NodeId existing_id(const std::string& label) const {
+        NodeId id = find(label);
+        if (id < 0) {
+            // Label does not exist
+            throw GraphwError("Given label does not exist");
+        }
+        return id;
+    }
+
+    // Return the label of an adjacency list entry
+    inline std::string node_label(const Node& node) const {
+        if constexpr (labelled) {
+            return node.label;
+        } else {
+            return std::to_string(node.id);
+        }
+    }
+
+    // Return the adjacency list entry of a neighbor with given id
+    inline Node entry(NodeId id, const EdgePayload& payload) const {
+        Node node;
+        node.id = id;
+        if constexpr (labelled) {
+            node.label = labels_vector[id];
+        }
+        if constexpr (!std::is_same<EdgePayload, NoPayload>::value) {
+            node.payload = payload;
+        }
+        return node;
+    }
+
+    // Append a node with given label, which is ignored with integer labels
+    void push_node(std::string label) {
+        version_++;
+        graph.emplace_back();
+        if (in_edge_index_) {
+            in_edges.emplace_back();
+        }
+        if (dense_ && graph.size() > stride * 64) {
+            // Rows are about to be widened, drop the matrix instead if the
+            // graph has become sparse
+            check_density();
+        }
+        if (dense_) {
+            grow_matrix();
+        }
+        if constexpr (labelled) {
+            labels_vector.push_back(std::move(label));
+        }
+        for (auto& column : attributes) {
+            column.second.push_back(0.0);
+        }
+    }
+
+    // Move the node with id order[i] to id i for every i
+    void permute(const std::vector<NodeId>& order) {
+        version_++;
+        size_t n = graph.size();
+        std::vector<NodeId> new_ids(n);
+        for (size_t i = 0; i < n; i++) {
+            new_ids[order[i]] = (NodeId)(i);
+        }
+        std::vector<std::vector<Node> > new_graph(n);
+        std::vector<std::string> new_labels(labels_vector.size());
+        for (size_t i = 0; i < n; i++) {
+            new_graph[i] = std::move(graph[order[i]]);
+            for (Node& neighbor : new_graph[i]) {
+                neighbor.id = new_ids[neighbor.id];
+            }
+            if constexpr (labelled) {
+                new_labels[i] = std::move(labels_vector[order[i]]);
+            }
+        }
+        graph = std::move(new_graph);
+        if constexpr (labelled) {
+            labels_vector = std::move(new_labels);
+        }
+        if (in_edge_index_) {
+            set_in_edge_index(true);
+        }
+        if (dense_) {
+            switch_matrix(true);
+        }
+        for (auto& identity : identities) {
+            identity.second = new_ids[identity.second];
+        }
+        for (auto& column : attributes) {
+            std::vector<double> values(n);
+            for (size_t i = 0; i < n; i++) {
+                values[i] = column.second[order[i]];
+            }
+            column.second = std::move(values);
+        }
+    }
+
+    // Append the adjacency list rows of nodes [begin, end) to buffer
+    void format_adjacency_list(size_t begin, size_t end,
+                               const std::string& delimiter,
+                               std::string& buffer) const {
+        for (size_t i = begin; i < end; i++) {
+            buffer += label((NodeId)(i));
+            buffer += delimiter;
+            for (auto const& neighbor : graph[i]) {
+                buffer += label(neighbor.id);
+                buffer += delimiter;
+            }
+            buffer += '\n';
+        }
+    }
+
+    // Pass the adjacency list to sink(data, size) in pieces of bounded size
+    template <typename Sink>
+    void write_adjacency_list_to(Sink sink, const std::string& delimiter,
+                                 bool parallel) const {
+        detail::write_ranges(
+            graph.size(), [this](size_t i) { return graph[i].size(); },
+            [&](size_t begin, size_t end, std::string& buffer) {
+                format_adjacency_list(begin, end, delimiter, buffer);
+            },
+            sink, parallel);
+    }
+
+    // Return the id of the node with given label, adding the node if it does
+    // not exist yet
+    NodeId intern(std::string_view label_view) {
+        if constexpr (labelled) {
+            std::string label(label_view);
+            auto it = identities.find(label);
+            if (it != identities.end()) {
+                return it->second;
+            }
+            NodeId id = (NodeId)(graph.size());
+            identities.emplace(label, id);
+            push_node(std::move(label));
+            return id;
+        } else {
+            NodeId id = parse_id(label_view);
+            while ((NodeId)(graph.size()) <= id) {
+                push_node(std::string());
+            }
+            return id;
+        }
+    }
+
+    // Append an edge between two existing node ids without checking whether
+    // the edge already exists
+    void append_edge(NodeId id1, NodeId id2, const EdgePayload& payload) {
+        edges++;
+        link(id1, entry(id2, payload));
+        if (!directed()) {
+            link(id2, entry(id1, payload));
+        }
     }
 
     // Checks if given node definition matches
     // graph existing node definition
-    bool does_node_exist(Node node) {
-        auto it = identities.find(node.label);
-        if (it == identities.end()) {
-            return false;
+    bool does_node_exist(const Node& node) const {
+        if constexpr (labelled) {
+            auto it = identities.find(node.label);
+            if (it == identities.end()) {
+                return false;
+            }
+            return node.id == it->second;
+        } else {
+            return node.id >= 0 && node.id < (NodeId)(graph.size());
         }
-        return node.id == it->second;
     }
 
     // Return if two labels are node neighbors
-    bool are_neighbors(const std::string& label1, const std::string& label2) {
-        std::list<std::string> neighbors = get_neighbors(label1);
-        if (std::any_of(neighbors.begin(), neighbors.end(),
-                        [label2](const std::string& neighbor) {
-                            return neighbor == label2;
-                        })) {
-            return true;
-        }
-        neighbors = get_neighbors(label2);
-        if (std::any_of(neighbors.begin(), neighbors.end(),
-                        [label1](const std::string& neighbor) {
-                            return neighbor == label1;
-                        })) {
-            return true;
-        }
-        return false;
+    bool are_neighbors(const std::string& label1,
+                       const std::string& label2) const {
+        NodeId node1_id = existing_id(label1);
+        NodeId node2_id = existing_id(label2);
+        return linked(node1_id, node2_id) || linked(node2_id, node1_id);
     }
 };
 
+typedef BasicGraph<> Graph;
+
 class ArcDiagram : public Graph {
    public:
     using Graph::Graph;
@@ -716,7 +1904,7 @@ class ArcDiagram : public Graph {
 class CircularLayout : public Graph {
    public:
     CircularLayout(bool new_directed_ = false, int new_node_radius_ = 20)
-        : directed_(new_directed_), node_radius_(new_node_radius_) {}
+        : Graph(new_directed_), node_radius_(new_node_radius_) {}
 
     // Return the node radius
     inline int node_radius() const { return node_radius_; }
@@ -726,15 +1914,34 @@ class CircularLayout : public Graph {
         node_radius_ = new_node_radius_;
     }
 
+    // Return the cached positions of the nodes on the unit circle, which are
+    // scaled to the window whenever the layout is drawn
+    inline const std::vector<PositionFloat>& positions() const {
+        return positions_;
+    }
+
+    // Return the version of the graph the cached positions belong to,
+    // UINT64_MAX if it is not known
+    inline uint64_t positions_version() const { return positions_version_; }
+
+    // Set the cached positions of the nodes on the unit circle and the
+    // version of the graph they belong to
+    inline void set_positions(std::vector<PositionFloat> new_positions_,
+                              uint64_t new_positions_version_ = UINT64_MAX) {
+        positions_ = std::move(new_positions_);
+        positions_version_ = new_positions_version_;
+    }
+
    private:
-    bool directed_;
     int node_radius_;
+    std::vector<PositionFloat> positions_;
+    uint64_t positions_version_ = UINT64_MAX;
 };
 
 class RandomLayout : public Graph {
    public:
     RandomLayout(bool new_directed_ = false, int new_node_radius_ = 20)
-        : directed_(new_directed_), node_radius_(new_node_radius_) {}
+        : Graph(new_directed_), node_radius_(new_node_radius_) {}
 
     // Return the node radius
     inline int node_radius() const { return node_radius_; }
@@ -745,7 +1952,6 @@ class RandomLayout : public Graph {
     }
 
    private:
-    bool directed_;
     int node_radius_;
 };
 
@@ -753,7 +1959,7 @@ class SpiralLayout : public Graph {
    public:
     SpiralLayout(bool new_directed_ = false, int new_node_radius_ = 10,
                  float new_resolution_ = 0.35, bool new_equidistant_ = false)
-        : directed_(new_directed_),
+        : Graph(new_directed_),
           node_radius_(new_node_radius_),
           resolution_(new_resolution_),
           equidistant_(new_equidistant_) {}
@@ -772,6 +1978,7 @@ class SpiralLayout : public Graph {
     // Set the resolution from given float
     inline void set_resolution(float new_resolution_) {
         resolution_ = new_resolution_;
+        set_positions({});
     }
 
     // Return whether spiral layout is set to be equidistant
@@ -780,22 +1987,45 @@ class SpiralLayout : public Graph {
     // Set the spiral to be equidistant or not
     inline void set_equidistant(bool new_equidistant_) {
         equidistant_ = new_equidistant_;
+        set_positions({});
+    }
+
+    // Return the cached positions of the nodes along the spiral before it is
+    // scaled to the window, which are cleared whenever the spiral changes
+    inline const std::vector<PositionFloat>& positions() const {
+        return positions_;
+    }
+
+    // Return the version of the graph the cached positions belong to,
+    // UINT64_MAX if it is not known
+    inline uint64_t positions_version() const { return positions_version_; }
+
+    // Set the cached positions of the nodes along the spiral and the version
+    // of the graph they belong to
+    inline void set_positions(std::vector<PositionFloat> new_positions_,
+                              uint64_t new_positions_version_ = UINT64_MAX) {
+        positions_ = std::move(new_positions_);
+        positions_version_ = new_positions_version_;
     }
 
    private:
-    bool directed_;
     int node_radius_;
     float resolution_;
     bool equidistant_;
+    std::vector<PositionFloat> positions_;
+    uint64_t positions_version_ = UINT64_MAX;
 };
 
 class ForceDirectedLayout : public Graph {
    public:
     ForceDirectedLayout(bool new_directed_ = false, int new_node_radius_ = 20,
-                        int new_iterations_ = 300)
-        : directed_(new_directed_),
+                        int new_iterations_ = 300, bool new_barnes_hut_ = false,
+                        float new_theta_ = 0.9)
+        : Graph(new_directed_),
           node_radius_(new_node_radius_),
-          iterations_(new_iterations_) {}
+          iterations_(new_iterations_),
+          barnes_hut_(new_barnes_hut_),
+          theta_(new_theta_) {}
 
     // Return the node radius
     inline int node_radius() const { return node_radius_; }
@@ -813,10 +2043,119 @@ class ForceDirectedLayout : public Graph {
         iterations_ = new_iterations_;
     }
 
+    // Return whether repulsion is approximated with a Barnes-Hut quadtree
+    inline bool barnes_hut() const { return barnes_hut_; }
+
+    // Set repulsion to be approximated with a Barnes-Hut quadtree or not
+    inline void set_barnes_hut(bool new_barnes_hut_) {
+        barnes_hut_ = new_barnes_hut_;
+    }
+
+    // Return the opening angle of the Barnes-Hut approximation
+    inline float theta() const { return theta_; }
+
+    // Set the opening angle of the Barnes-Hut approximation from given float
+    inline void set_theta(float new_theta_) { theta_ = new_theta_; }
+
+    // Return the number of threads the layout is computed with, 0 for one per
+    // hardware thread
+    inline size_t threads() const { return threads_; }
+
+    // Set the number of threads the layout is computed with, 0 for one per
+    // hardware thread
+    inline void set_threads(size_t new_threads_) { threads_ = new_threads_; }
+
+    // Return whether the maximum movement of a node adapts to the progress of
+    // the layout instead of cooling down linearly
+    inline bool adaptive_cooling() const { return adaptive_cooling_; }
+
+    // Set the maximum movement of a node to adapt to the progress of the
+    // layout or to cool down linearly
+    inline void set_adaptive_cooling(bool new_adaptive_cooling_) {
+        adaptive_cooling_ = new_adaptive_cooling_;
+    }
+
+    // Return the tolerance, iterations stop once no node moves more than
+    // tolerance times the optimal distance between nodes, never for 0
+    inline float tolerance() const { return tolerance_; }
+
+    // Set the tolerance from given float
+    inline void set_tolerance(float new_tolerance_) {
+        tolerance_ = new_tolerance_;
+    }
+
+    // Return the time budget of the layout in milliseconds, 0 for none
+    inline int time_budget() const { return time_budget_; }
+
+    // Set the time budget of the layout in milliseconds, 0 for none
+    inline void set_time_budget(int new_time_budget_) {
+        time_budget_ = new_time_budget_;
+    }
+
+    // Return the positions in the unit square of the last updated layout,
+    // which the next update starts from
+    inline const std::vector<PositionFloat>& positions() const {
+        return positions_;
+    }
+
+    // Return the version of the graph the positions were laid out for,
+    // UINT64_MAX if it is not known
+    inline uint64_t positions_version() const { return positions_version_; }
+
+    // Set the positions in the unit square the next update starts from,
+    // empty to lay out the graph from scratch, and the version of the graph
+    // they were laid out for. Nodes without a position are treated as new.
+    inline void set_positions(std::vector<PositionFloat> new_positions_,
+                              uint64_t new_positions_version_ = UINT64_MAX) {
+        positions_ = std::move(new_positions_);
+        positions_version_ = new_positions_version_;
+    }
+
    private:
-    bool directed_;
     int node_radius_;
     int iterations_;
+    bool barnes_hut_;
+    float theta_;
+    size_t threads_ = 0;
+    bool adaptive_cooling_ = false;
+    float tolerance_ = 0;
+    int time_budget_ = 0;
+    std::vector<PositionFloat> positions_;
+    uint64_t positions_version_ = UINT64_MAX;
+};
+
+class MultilevelForceDirectedLayout : public ForceDirectedLayout {
+   public:
+    MultilevelForceDirectedLayout(bool new_directed_ = false,
+                                  int new_node_radius_ = 20,
+                                  int new_iterations_ = 300,
+                                  NodeId new_coarsest_size_ = 300,
+                                  int new_refinement_iterations_ = 30)
+        : ForceDirectedLayout(new_directed_, new_node_radius_,
+                              new_iterations_, true),
+          coarsest_size_(new_coarsest_size_),
+          refinement_iterations_(new_refinement_iterations_) {}
+
+    // Return the number of nodes below which the graph is not coarsened
+    inline NodeId coarsest_size() const { return coarsest_size_; }
+
+    // Set the number of nodes below which the graph is not coarsened
+    inline void set_coarsest_size(NodeId new_coarsest_size_) {
+        coarsest_size_ = new_coarsest_size_;
+    }
+
+    // Return the number of iterations run on each level finer than the
+    // coarsest
+    inline int refinement_iterations() const { return refinement_iterations_; }
+
+    // Set the number of iterations run on each level finer than the coarsest
+    inline void set_refinement_iterations(int new_refinement_iterations_) {
+        refinement_iterations_ = new_refinement_iterations_;
+    }
+
+   private:
+    NodeId coarsest_size_;
+    int refinement_iterations_;
 };
 }  // namespace graphw
 #endif
@@ -0,0 +1,405 @@
+#ifndef GRAPHW_COMPRESSED
+#define GRAPHW_COMPRESSED
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_csr.hpp"
+
+namespace graphw {
+namespace detail {
+// Append value to buffer as a varint of 7 bits per byte, where the high bit
+// of a byte is set if more bytes follow
+inline void append_varint(std::vector<uint8_t>& buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((uint8_t)(value));
+}
+
+// Decode a varint at position and advance position past it
+inline uint64_t read_varint(const uint8_t*& position) {
+    uint64_t value = *position++;
+    if (value < 0x80) {
+        return value;
+    }
+    value &= 0x7f;
+    for (int shift = 7;; shift += 7) {
+        uint64_t byte = *position++;
+        value |= (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+}
+
+// Return position advanced past count varints. Eight bytes are checked at a
+// time by counting the bytes which end a varint, so the buffer must be
+// followed by at least seven readable bytes.
+inline const uint8_t* skip_varints(const uint8_t* position, size_t count) {
+    const uint64_t high_bits = 0x8080808080808080ull;
+    while (count > 0) {
+        uint64_t word;
+        memcpy(&word, position, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        uint64_t ends = ~word & high_bits;
+        size_t found = (size_t)(__builtin_popcountll(ends));
+        if (found < count) {
+            count -= found;
+            position += 8;
+            continue;
+        }
+        // Drop the ends before the last one needed
+        for (; count > 1; count--) {
+            ends &= ends - 1;
+        }
+        // The first byte is the lowest byte of the word
+        return position + __builtin_ctzll(ends) / 8 + 1;
+    }
+    return position;
+}
+
+inline uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)(value) << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+}  // namespace detail
+
+// Iterates over the neighbor ids of a node in a CompressedGraph, decoding them
+// one at a time
+class CompressedNeighborIterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = NodeId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const NodeId*;
+    using reference = NodeId;
+
+    CompressedNeighborIterator(const uint8_t* new_position,
+                               size_t new_remaining, NodeId id)
+        : position(new_position), remaining(new_remaining), value(0) {
+        if (remaining > 0) {
+            // The first neighbor is stored relative to the node itself
+            value = (NodeId)(id + detail::zigzag_decode(
+                                   detail::read_varint(position)));
+        }
+    }
+
+    inline NodeId operator*() const { return value; }
+
+    inline CompressedNeighborIterator& operator++() {
+        if (--remaining > 0) {
+            value += (NodeId)(detail::read_varint(position));
+        }
+        return *this;
+    }
+
+    inline CompressedNeighborIterator operator++(int) {
+        CompressedNeighborIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    inline bool operator==(const CompressedNeighborIterator& other) const {
+        return remaining == other.remaining;
+    }
+
+    inline bool operator!=(const CompressedNeighborIterator& other) const {
+        return remaining != other.remaining;
+    }
+
+   private:
+    const uint8_t* position;
+    size_t remaining;
+    NodeId value;
+};
+
+// Neighbor ids of a node in a CompressedGraph, in increasing order
+struct CompressedNeighborRange {
+    const uint8_t* first;
+    size_t count;
+    NodeId id;
+
+    inline CompressedNeighborIterator begin() const {
+        return CompressedNeighborIterator(first, count, id);
+    }
+
+    inline CompressedNeighborIterator end() const {
+        return CompressedNeighborIterator(nullptr, 0, id);
+    }
+
+    inline size_t size() const { return count; }
+};
+
+// Read-only graph whose adjacency lists are sorted and compressed. Each list
+// is stored as its length, the gap from the node's own id to its first
+// neighbor and the gaps between consecutive neighbors, all as varints. The
+// byte offset of every block_size-th list is kept so that a list can be found
+// by skipping at most block_size - 1 lists.
+class CompressedGraph {
+   public:
+    static const size_t block_size = 32;
+
+    CompressedGraph() : CompressedGraph(CSRGraph()) {}
+
+    // Construct from a graph, copying its adjacency and labels
+    explicit CompressedGraph(const Graph& g) : CompressedGraph(CSRGraph(g)) {}
+
+    // Construct from a CSR graph, copying its adjacency and labels
+    explicit CompressedGraph(const CSRGraph& g)
+        : nodes_(g.number_of_nodes()),
+          entries_(0),
+          edges_(g.number_of_edges()),
+          directed_(g.directed()) {
+        encode(g);
+        if (g.has_labels()) {
+            copy_labels(g);
+        }
+    }
+
+    // Return whether graph is directed
+    inline bool directed() const { return directed_; }
+
+    // Return number of nodes
+    inline NodeId number_of_nodes() const { return (NodeId)(nodes_); }
+
+    // Return number of edges
+    inline EdgeCount number_of_edges() const { return edges_; }
+
+    // Return whether nodes have labels, nodes without labels are labelled by
+    // their id
+    inline bool has_labels() const { return !label_offsets_.empty(); }
+
+    // Return the number of bytes used by the compressed adjacency lists and
+    // their index
+    inline size_t adjacency_bytes() const {
+        return data_.size() + index_.size() * sizeof(uint64_t);
+    }
+
+    // Return the neighbor ids of the node with given id in increasing order
+    CompressedNeighborRange neighbors(NodeId id) const {
+        const uint8_t* position = data_.data() + index_[id / block_size];
+        for (size_t i = id % block_size; i > 0; i--) {
+            size_t count = (size_t)(detail::read_varint(position));
+            position = detail::skip_varints(position, count);
+        }
+        size_t count = (size_t)(detail::read_varint(position));
+        return {position, count, id};
+    }
+
+    // Return the label of the node with given id
+    std::string label(NodeId id) const {
+        if (!has_labels()) {
+            return std::to_string(id);
+        }
+        return std::string(label_view(id));
+    }
+
+    // Return the id of the node with given label
+    NodeId id(const std::string& label) const {
+        NodeId node_id = find(label);
+        if (node_id < 0) {
+            // Label does not exist
+            throw GraphwError("Given label does not exist");
+        }
+        return node_id;
+    }
+
+    // Return the density of the graph
+    float density() const {
+        float size = (float)(nodes_);
+        if (directed_) {
+            return (float)(edges_ / (size * (size - 1)));
+        }
+        return (float)((2 * edges_) / (size * (size - 1)));
+    }
+
+    // Return the degree of a node with given label
+    EdgeCount degree(const std::string& label) const {
+        return (EdgeCount)(neighbors(id(label)).size());
+    }
+
+    // Return the average degree of the graph
+    float average_degree() const {
+        return ((float)entries_ / (float)nodes_);
+    }
+
+    // Return a list of labels representing the neighbor of a given node label
+    std::list<std::string> get_neighbors(const std::string& label) const {
+        std::list<std::string> neighbors_list;
+        for (NodeId neighbor_id : neighbors(id(label))) {
+            neighbors_list.push_back(this->label(neighbor_id));
+        }
+        return neighbors_list;
+    }
+
+    // Return a list of labels representing the common neighbors of two nodes,
+    // merging their sorted neighbor lists
+    std::list<std::string> get_common_neighbors(
+        const std::string& label1, const std::string& label2) const {
+        CompressedNeighborRange neighbors1 = neighbors(id(label1));
+        CompressedNeighborRange neighbors2 = neighbors(id(label2));
+        std::list<std::string> common_neighbors;
+        auto it1 = neighbors1.begin();
+        auto it2 = neighbors2.begin();
+        while (it1 != neighbors1.end() && it2 != neighbors2.end()) {
+            if (*it1 < *it2) {
+                ++it1;
+            } else if (*it2 < *it1) {
+                ++it2;
+            } else {
+                NodeId common_id = *it1;
+                common_neighbors.push_back(label(common_id));
+                // Skip repeated entries of the same neighbor
+                while (it1 != neighbors1.end() && *it1 == common_id) {
+                    ++it1;
+                }
+                while (it2 != neighbors2.end() && *it2 == common_id) {
+                    ++it2;
+                }
+            }
+        }
+        return common_neighbors;
+    }
+
+    // Return the adjacency list in the format of Graph::get_adjacency_list,
+    // with neighbors in increasing id order
+    std::string get_adjacency_list(const std::string& delimiter = " ") const {
+        std::string adjacency_list;
+        for (size_t i = 0; i < nodes_; i++) {
+            adjacency_list += label(i);
+            adjacency_list += delimiter;
+            for (NodeId neighbor_id : neighbors(i)) {
+                adjacency_list += label(neighbor_id);
+                adjacency_list += delimiter;
+            }
+            adjacency_list += '\n';
+        }
+        return adjacency_list;
+    }
+
+   private:
+    size_t nodes_;
+    size_t entries_;
+    EdgeCount edges_;
+    bool directed_;
+    std::vector<uint8_t> data_;
+    // Offset in data_ of the list of every block_size-th node
+    std::vector<uint64_t> index_;
+    std::vector<uint64_t> label_offsets_;
+    std::string label_chars_;
+    // Node ids sorted by label for lookups
+    std::vector<NodeId> label_order_;
+
+    // Compress the adjacency lists of a graph, blocks of nodes are encoded in
+    // parallel and then concatenated
+    void encode(const CSRGraph& g) {
+        size_t blocks = (nodes_ + block_size - 1) / block_size;
+        std::vector<std::vector<uint8_t> > buffers(blocks);
+        std::vector<size_t> block_entries(blocks, 0);
+        detail::parallel_for(blocks, [&](size_t block) {
+            std::vector<NodeId> sorted;
+            size_t end = std::min(nodes_, (block + 1) * block_size);
+            for (size_t i = block * block_size; i < end; i++) {
+                NeighborRange range = g.neighbors(i);
+                sorted.assign(range.begin(), range.end());
+                std::sort(sorted.begin(), sorted.end());
+                detail::append_varint(buffers[block], sorted.size());
+                for (size_t j = 0; j < sorted.size(); j++) {
+                    if (j == 0) {
+                        detail::append_varint(
+                            buffers[block],
+                            detail::zigzag_encode((int64_t)(sorted[0]) -
+                                                  (int64_t)(i)));
+                    } else {
+                        detail::append_varint(buffers[block],
+                                              sorted[j] - sorted[j - 1]);
+                    }
+                }
+                block_entries[block] += sorted.size();
+            }
+        });
+        index_.resize(blocks);
+        size_t size = 0;
+        for (size_t block = 0; block < blocks; block++) {
+            index_[block] = size;
+            size += buffers[block].size();
+            entries_ += block_entries[block];
+        }
+        // Padding lets skip_varints read whole words at the end
+        data_.reserve(size + 8);
+        for (auto& buffer : buffers) {
+            data_.insert(data_.end(), buffer.begin(), buffer.end());
+            std::vector<uint8_t>().swap(buffer);
+        }
+        data_.resize(size + 8, 0);
+    }
+
+    // Copy the labels of a graph and sort ids by label
+    void copy_labels(const CSRGraph& g) {
+        label_offsets_.resize(nodes_ + 1);
+        label_offsets_[0] = 0;
+        for (size_t i = 0; i < nodes_; i++) {
+            label_chars_ += g.label(i);
+            label_offsets_[i + 1] = label_chars_.size();
+        }
+        label_order_.resize(nodes_);
+        for (size_t i = 0; i < nodes_; i++) {
+            label_order_[i] = (NodeId)(i);
+        }
+        std::sort(label_order_.begin(), label_order_.end(),
+                  [this](NodeId id1, NodeId id2) {
+                      return label_view(id1) < label_view(id2);
+                  });
+    }
+
+    // Return the label of a labelled node without copying it
+    inline std::string_view label_view(NodeId id) const {
+        return std::string_view(label_chars_.data() + label_offsets_[id],
+                                label_offsets_[id + 1] - label_offsets_[id]);
+    }
+
+    // Return the id of the node with given label or -1 if it does not exist
+    NodeId find(std::string_view label) const {
+        if (!has_labels()) {
+            NodeId node_id = -1;
+            auto result =
+                std::from_chars(label.data(), label.data() + label.size(),
+                                node_id);
+            if (result.ec != std::errc() ||
+                result.ptr != label.data() + label.size() || node_id < 0 ||
+                (size_t)(node_id) >= nodes_ ||
+                std::to_string(node_id) != label) {
+                return -1;
+            }
+            return node_id;
+        }
+        auto it = std::lower_bound(
+            label_order_.begin(), label_order_.end(), label,
+            [this](NodeId node_id, std::string_view value) {
+                return label_view(node_id) < value;
+            });
+        if (it == label_order_.end() || label_view(*it) != label) {
+            return -1;
+        }
+        return *it;
+    }
+};
+}  // namespace graphw
+#endif
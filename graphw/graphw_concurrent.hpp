@@ -0,0 +1,570 @@
+#ifndef GRAPHW_CONCURRENT
+#define GRAPHW_CONCURRENT
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_csr.hpp"
+
+namespace graphw {
+namespace detail {
+// Call function(begin, end) for consecutive ranges of [0, n) in parallel
+template <typename Function>
+void parallel_ranges(size_t n, Function function) {
+    const size_t range_size = 4096;
+    parallel_for((n + range_size - 1) / range_size, [&](size_t range) {
+        function(range * range_size, std::min(n, (range + 1) * range_size));
+    });
+}
+
+// Return whether label1 comes before label2 in shortlex order, which is
+// numeric order for labels which are non-negative integers
+inline bool shortlex_less(const std::string& label1,
+                          const std::string& label2) {
+    if (label1.size() != label2.size()) {
+        return label1.size() < label2.size();
+    }
+    return label1 < label2;
+}
+}  // namespace detail
+
+// Collects nodes and edges from many threads at once and builds a Graph or
+// CSRGraph from them. Labels and adjacency lists are split into shards by label
+// hash with one mutex per shard, so threads only contend when they touch the
+// same shard. Unlike Graph::add_edge, duplicate edges are not filtered out.
+class ConcurrentGraphBuilder {
+   public:
+    ConcurrentGraphBuilder(bool new_directed_ = false, size_t new_shards_ = 0)
+        : directed_(new_directed_),
+          shards_(new_shards_ > 0 ? new_shards_
+                                  : 8 * detail::thread_count(SIZE_MAX)),
+          shards(new Shard[shards_]),
+          next_id(0),
+          edges(0) {}
+
+    // Add a node with given label if it does not exist yet, safe to call from
+    // multiple threads
+    void add_node(std::string_view label) {
+        Shard& shard = shards[shard_index(label)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        intern(shard, label);
+    }
+
+    // Add an edge between two nodes given two node labels, adding nodes which
+    // do not exist yet. Safe to call from multiple threads.
+    void add_edge(std::string_view label1, std::string_view label2) {
+        Shard& shard1 = shards[shard_index(label1)];
+        Shard& shard2 = shards[shard_index(label2)];
+        if (&shard1 == &shard2) {
+            std::lock_guard<std::mutex> lock(shard1.mutex);
+            link(shard1, label1, shard2, label2);
+        } else {
+            // scoped_lock acquires both mutexes without deadlocking
+            std::scoped_lock lock(shard1.mutex, shard2.mutex);
+            link(shard1, label1, shard2, label2);
+        }
+        edges.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Build a graph from the added nodes and edges, leaving the builder empty.
+    // Nodes are given ids in the order they were first added, which depends on
+    // how threads interleave. If deterministic is set, ids follow the shortlex
+    // order of labels (numeric order for integer labels) and neighbors are
+    // sorted by id instead. Must not be called while edges are being added.
+    Graph build(bool deterministic = false) {
+        std::vector<std::string> labels;
+        std::vector<std::vector<NodeId> > adjacency;
+        EdgeCount edges_count = collect(deterministic, labels, adjacency);
+        Graph g(directed_);
+        size_t nodes = labels.size();
+        g.identities.reserve(nodes);
+        for (size_t i = 0; i < nodes; i++) {
+            g.identities.emplace(labels[i], (NodeId)(i));
+        }
+        g.graph.resize(nodes);
+        detail::parallel_ranges(nodes, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                std::vector<Node>& neighbors = g.graph[i];
+                neighbors.reserve(adjacency[i].size());
+                for (NodeId neighbor_id : adjacency[i]) {
+                    neighbors.push_back({neighbor_id, labels[neighbor_id]});
+                }
+                std::vector<NodeId>().swap(adjacency[i]);
+            }
+        });
+        g.labels_vector = std::move(labels);
+        g.edges = edges_count;
+        return g;
+    }
+
+    // Build a CSR graph from the added nodes and edges, leaving the builder
+    // empty. Ids are assigned as in build.
+    CSRGraph build_csr(bool deterministic = false) {
+        std::vector<std::string> labels;
+        std::vector<std::vector<NodeId> > adjacency;
+        EdgeCount edges_count = collect(deterministic, labels, adjacency);
+        size_t nodes = labels.size();
+        auto arrays = std::make_shared<CSRGraph::Arrays>();
+        arrays->offsets.resize(nodes + 1);
+        arrays->label_offsets.resize(nodes + 1);
+        arrays->offsets[0] = 0;
+        arrays->label_offsets[0] = 0;
+        for (size_t i = 0; i < nodes; i++) {
+            arrays->offsets[i + 1] = arrays->offsets[i] + adjacency[i].size();
+            arrays->label_offsets[i + 1] =
+                arrays->label_offsets[i] + labels[i].size();
+        }
+        arrays->targets.resize(arrays->offsets[nodes]);
+        arrays->label_chars.resize(arrays->label_offsets[nodes]);
+        detail::parallel_ranges(nodes, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                std::copy(adjacency[i].begin(), adjacency[i].end(),
+                          arrays->targets.begin() + arrays->offsets[i]);
+                std::copy(labels[i].begin(), labels[i].end(),
+                          arrays->label_chars.begin() +
+                              arrays->label_offsets[i]);
+                std::vector<NodeId>().swap(adjacency[i]);
+            }
+        });
+        arrays->label_order.resize(nodes);
+        std::iota(arrays->label_order.begin(), arrays->label_order.end(), 0);
+        std::sort(arrays->label_order.begin(), arrays->label_order.end(),
+                  [&labels](NodeId id1, NodeId id2) {
+                      return labels[id1] < labels[id2];
+                  });
+        return CSRGraph(arrays, edges_count, directed_);
+    }
+
+    // Return whether graph is directed
+    inline bool directed() const { return directed_; }
+
+    // Return number of nodes added so far
+    inline NodeId number_of_nodes() const { return next_id.load(); }
+
+    // Return number of edges added so far
+    inline EdgeCount number_of_edges() const { return edges.load(); }
+
+   private:
+    // Nodes whose label hashes to the shard, indexed by their position in the
+    // shard. Aligned so that shards do not share cache lines.
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, uint32_t> positions;
+        std::vector<NodeId> ids;
+        std::vector<std::vector<NodeId> > adjacency;
+    };
+
+    bool directed_;
+    size_t shards_;
+    std::unique_ptr<Shard[]> shards;
+    std::atomic<NodeId> next_id;
+    std::atomic<EdgeCount> edges;
+
+    inline size_t shard_index(std::string_view label) const {
+        return std::hash<std::string_view>()(label) % shards_;
+    }
+
+    // Return the position of the node with given label in its shard, adding
+    // the node if it does not exist. The shard must be locked.
+    uint32_t intern(Shard& shard, std::string_view label) {
+        auto inserted = shard.positions.emplace(
+            std::string(label), (uint32_t)(shard.ids.size()));
+        if (inserted.second) {
+            shard.ids.push_back(next_id.fetch_add(1));
+            shard.adjacency.emplace_back();
+        }
+        return inserted.first->second;
+    }
+
+    // Add the adjacency entries of an edge, both shards must be locked
+    void link(Shard& shard1, std::string_view label1, Shard& shard2,
+              std::string_view label2) {
+        uint32_t position1 = intern(shard1, label1);
+        uint32_t position2 = intern(shard2, label2);
+        shard1.adjacency[position1].push_back(shard2.ids[position2]);
+        if (!directed_) {
+            shard2.adjacency[position2].push_back(shard1.ids[position1]);
+        }
+    }
+
+    // Move labels and adjacency lists out of the shards indexed by node id,
+    // reset the builder and return the number of edges
+    EdgeCount collect(bool deterministic, std::vector<std::string>& labels,
+                std::vector<std::vector<NodeId> >& adjacency) {
+        size_t nodes = next_id.load();
+        labels.resize(nodes);
+        adjacency.resize(nodes);
+        detail::parallel_for(shards_, [&](size_t s) {
+            Shard& shard = shards[s];
+            while (!shard.positions.empty()) {
+                auto entry = shard.positions.extract(shard.positions.begin());
+                NodeId id = shard.ids[entry.mapped()];
+                labels[id] = std::move(entry.key());
+                adjacency[id] = std::move(shard.adjacency[entry.mapped()]);
+            }
+            std::vector<NodeId>().swap(shard.ids);
+            std::vector<std::vector<NodeId> >().swap(shard.adjacency);
+        });
+        if (deterministic) {
+            std::vector<NodeId> order(nodes);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(),
+                      [&labels](NodeId id1, NodeId id2) {
+                          return detail::shortlex_less(labels[id1],
+                                                       labels[id2]);
+                      });
+            std::vector<NodeId> new_ids(nodes);
+            std::vector<std::string> sorted_labels(nodes);
+            std::vector<std::vector<NodeId> > sorted_adjacency(nodes);
+            for (size_t i = 0; i < nodes; i++) {
+                new_ids[order[i]] = (NodeId)(i);
+                sorted_labels[i] = std::move(labels[order[i]]);
+                sorted_adjacency[i] = std::move(adjacency[order[i]]);
+            }
+            detail::parallel_ranges(nodes, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    for (NodeId& neighbor_id : sorted_adjacency[i]) {
+                        neighbor_id = new_ids[neighbor_id];
+                    }
+                    std::sort(sorted_adjacency[i].begin(),
+                              sorted_adjacency[i].end());
+                }
+            });
+            labels = std::move(sorted_labels);
+            adjacency = std::move(sorted_adjacency);
+        }
+        next_id = 0;
+        return edges.exchange(0);
+    }
+};
+
+// A graph which one writer thread modifies while any number of reader threads
+// query it without locking. Readers pin an immutable snapshot of the latest
+// published version. The writer's changes are made to a new version which
+// shares all unchanged chunks of nodes with the previous one and becomes
+// visible when it is published. Versions which are no longer current are freed
+// once no reader has them pinned, tracked with epoch-based reclamation.
+class VersionedGraph {
+    struct Version;
+
+   public:
+    // An immutable view of one version of a VersionedGraph, which keeps the
+    // version alive until it is destroyed
+    class Snapshot {
+       public:
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot(Snapshot&& other) noexcept
+            : version(other.version),
+              slot(other.slot),
+              directed_(other.directed_) {
+            other.slot = nullptr;
+        }
+
+        ~Snapshot() {
+            if (slot) {
+                slot->store(0);
+            }
+        }
+
+        // Return whether graph is directed
+        inline bool directed() const { return directed_; }
+
+        // Return number of nodes in the snapshot
+        inline NodeId number_of_nodes() const {
+            return (NodeId)(version->nodes);
+        }
+
+        // Return number of edges in the snapshot
+        inline EdgeCount number_of_edges() const { return version->edges; }
+
+        // Return the label of the node with given id
+        inline const std::string& label(NodeId id) const {
+            return version->chunks[id / chunk_size]
+                ->labels[id % chunk_size];
+        }
+
+        // Return the ids of the neighbors of the node with given id
+        inline const std::vector<NodeId>& neighbors(NodeId id) const {
+            return version->chunks[id / chunk_size]
+                ->adjacency[id % chunk_size];
+        }
+
+        // Return the degree of a node given its label
+        EdgeCount degree(const std::string& label) const {
+            return (EdgeCount)(neighbors(existing_id(label)).size());
+        }
+
+        // Return a list of labels representing the neighbor of a given node
+        // label
+        std::list<std::string> get_neighbors(const std::string& label) const {
+            std::list<std::string> neighbor_labels;
+            for (NodeId neighbor_id : neighbors(existing_id(label))) {
+                neighbor_labels.push_back(this->label(neighbor_id));
+            }
+            return neighbor_labels;
+        }
+
+        // Return a list of labels representing the common neighbors of two
+        // nodes, in the order they are neighbors of the first node
+        std::list<std::string> get_common_neighbors(
+            const std::string& label1, const std::string& label2) const {
+            const std::vector<NodeId>& neighbors1 =
+                neighbors(existing_id(label1));
+            const std::vector<NodeId>& neighbors2 =
+                neighbors(existing_id(label2));
+            std::list<std::string> common_neighbors;
+            for (NodeId neighbor_id : neighbors1) {
+                if (std::find(neighbors2.begin(), neighbors2.end(),
+                              neighbor_id) != neighbors2.end()) {
+                    common_neighbors.push_back(label(neighbor_id));
+                }
+            }
+            return common_neighbors;
+        }
+
+       private:
+        friend class VersionedGraph;
+
+        const Version* version;
+        std::atomic<uint64_t>* slot;
+        bool directed_;
+
+        Snapshot(const Version* new_version, std::atomic<uint64_t>* new_slot,
+                 bool new_directed_)
+            : version(new_version), slot(new_slot), directed_(new_directed_) {}
+
+        NodeId existing_id(const std::string& label) const {
+            NodeId id = find(*version, label);
+            if (id < 0) {
+                throw GraphwError("Given label does not exist");
+            }
+            return id;
+        }
+    };
+
+    VersionedGraph(bool new_directed_ = false, size_t max_readers = 0)
+        : directed_(new_directed_),
+          current(new Version()),
+          epoch(1),
+          slots_(max_readers > 0
+                     ? max_readers
+                     : std::max<size_t>(64,
+                                        8 * detail::thread_count(SIZE_MAX))),
+          slots(new Slot[slots_]) {
+        current.load()->index.resize(index_shards);
+        for (auto& shard : current.load()->index) {
+            shard = std::make_shared<IndexShard>();
+        }
+    }
+
+    VersionedGraph(const VersionedGraph&) = delete;
+    VersionedGraph& operator=(const VersionedGraph&) = delete;
+
+    // All snapshots must be destroyed before the graph
+    ~VersionedGraph() {
+        delete current.load();
+        for (auto& entry : retired) {
+            delete entry.first;
+        }
+    }
+
+    // Add node with given label to the next version. Must only be called by
+    // the writer thread.
+    void add_node(std::string label = "") {
+        Version& version = next_version();
+        if (label.empty()) {
+            // No label was set, make label equal id
+            label = std::to_string(version.nodes);
+        }
+        if (find(version, label) >= 0) {
+            throw GraphwError("Could not add node with duplicate label");
+        }
+        intern(version, std::move(label));
+    }
+
+    // Add an edge between two nodes given two node labels to the next version,
+    // adding nodes which do not exist. Edges which already exist are ignored.
+    // Must only be called by the writer thread.
+    void add_edge(const std::string& label1, const std::string& label2) {
+        Version& version = next_version();
+        NodeId id1 = find(version, label1);
+        if (id1 < 0) {
+            id1 = intern(version, label1);
+        }
+        NodeId id2 = find(version, label2);
+        if (id2 < 0) {
+            id2 = intern(version, label2);
+        }
+        const std::vector<NodeId>& neighbors =
+            version.chunks[id1 / chunk_size]->adjacency[id1 % chunk_size];
+        if (std::find(neighbors.begin(), neighbors.end(), id2) !=
+            neighbors.end()) {
+            return;
+        }
+        writable_chunk(version, id1 / chunk_size)
+            .adjacency[id1 % chunk_size]
+            .push_back(id2);
+        if (!directed_) {
+            writable_chunk(version, id2 / chunk_size)
+                .adjacency[id2 % chunk_size]
+                .push_back(id1);
+        }
+        version.edges++;
+    }
+
+    // Make the changes since the last call visible to new snapshots and free
+    // old versions which are no longer pinned. Must only be called by the
+    // writer thread.
+    void publish() {
+        if (next) {
+            Version* previous = current.exchange(next.release());
+            retired.emplace_back(previous, epoch.fetch_add(1));
+        }
+        reclaim();
+    }
+
+    // Return a snapshot of the latest published version, safe to call from
+    // multiple threads. Waits if max_readers snapshots are already alive.
+    Snapshot snapshot() const {
+        size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (;;) {
+            for (size_t i = 0; i < slots_; i++) {
+                std::atomic<uint64_t>& slot = slots[(start + i) % slots_].epoch;
+                uint64_t free = 0;
+                // A version read after pinning the epoch is only retired
+                // later, with an epoch no lower than the pinned one
+                if (slot.load() == 0 &&
+                    slot.compare_exchange_strong(free, epoch.load())) {
+                    return Snapshot(current.load(), &slot, directed_);
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    // Return whether graph is directed
+    inline bool directed() const { return directed_; }
+
+   private:
+    static const size_t chunk_size = 256;
+    static const size_t index_shards = 256;
+
+    // Labels and neighbor ids of chunk_size consecutive nodes
+    struct Chunk {
+        std::vector<std::string> labels;
+        std::vector<std::vector<NodeId> > adjacency;
+    };
+
+    using IndexShard = std::unordered_map<std::string, NodeId>;
+
+    // Chunks and index shards are shared between versions and never modified
+    // once their version is published
+    struct Version {
+        size_t nodes = 0;
+        EdgeCount edges = 0;
+        std::vector<std::shared_ptr<Chunk> > chunks;
+        std::vector<std::shared_ptr<IndexShard> > index;
+    };
+
+    // The epoch pinned by a reader, or 0 if unused
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    bool directed_;
+    std::atomic<Version*> current;
+    std::unique_ptr<Version> next;
+    std::vector<bool> owned_chunks;
+    std::vector<bool> owned_index;
+    std::vector<std::pair<Version*, uint64_t> > retired;
+    std::atomic<uint64_t> epoch;
+    size_t slots_;
+    std::unique_ptr<Slot[]> slots;
+
+    // Return the id of the node with given label in a version, or -1
+    static NodeId find(const Version& version, const std::string& label) {
+        const IndexShard& shard =
+            *version.index[std::hash<std::string>()(label) % index_shards];
+        auto it = shard.find(label);
+        return it == shard.end() ? -1 : it->second;
+    }
+
+    // Return the version being written, starting it from the current one if
+    // needed
+    Version& next_version() {
+        if (!next) {
+            next.reset(new Version(*current.load()));
+            owned_chunks.assign(next->chunks.size(), false);
+            owned_index.assign(index_shards, false);
+        }
+        return *next;
+    }
+
+    // Return a chunk of the next version which can be modified, copying it
+    // the first time it is modified in this version
+    Chunk& writable_chunk(Version& version, size_t chunk) {
+        if (!owned_chunks[chunk]) {
+            version.chunks[chunk] =
+                std::make_shared<Chunk>(*version.chunks[chunk]);
+            owned_chunks[chunk] = true;
+        }
+        return *version.chunks[chunk];
+    }
+
+    // Add a node to the next version and return its id
+    NodeId intern(Version& version, std::string label) {
+        NodeId id = (NodeId)(version.nodes++);
+        if (id % chunk_size == 0) {
+            version.chunks.push_back(std::make_shared<Chunk>());
+            owned_chunks.push_back(true);
+        }
+        Chunk& chunk = writable_chunk(version, id / chunk_size);
+        chunk.labels.push_back(label);
+        chunk.adjacency.emplace_back();
+        size_t shard = std::hash<std::string>()(label) % index_shards;
+        if (!owned_index[shard]) {
+            version.index[shard] =
+                std::make_shared<IndexShard>(*version.index[shard]);
+            owned_index[shard] = true;
+        }
+        version.index[shard]->emplace(std::move(label), id);
+        return id;
+    }
+
+    // Free retired versions older than the epoch of every pinned snapshot
+    void reclaim() {
+        uint64_t oldest = UINT64_MAX;
+        for (size_t i = 0; i < slots_; i++) {
+            uint64_t pinned = slots[i].epoch.load();
+            if (pinned != 0) {
+                oldest = std::min(oldest, pinned);
+            }
+        }
+        auto freed = std::partition(
+            retired.begin(), retired.end(),
+            [oldest](const std::pair<Version*, uint64_t>& entry) {
+                return entry.second >= oldest;
+            });
+        for (auto it = freed; it != retired.end(); it++) {
+            delete it->first;
+        }
+        retired.erase(freed, retired.end());
+    }
+};
+}  // namespace graphw
+#endif
@@ -0,0 +1,660 @@
+#ifndef GRAPHW_CSR
+#define GRAPHW_CSR
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "graphw.hpp"
+
+namespace graphw {
+namespace detail {
+const char snapshot_magic[8] = {'G', 'R', 'A', 'P', 'H', 'W', 'S', 'N'};
+const uint32_t snapshot_version = 1;
+const uint32_t snapshot_byte_order = 0x01020304;
+const uint32_t snapshot_directed = 1;
+const uint32_t snapshot_labels = 2;
+// Sections are aligned so arrays can be used in place from the mapping
+const uint64_t snapshot_alignment = 64;
+
+// Fixed size header at the start of a snapshot, followed by section_count
+// SnapshotSection entries
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t flags;
+    uint32_t id_size;
+    uint64_t nodes;
+    uint64_t entries;
+    uint64_t edges;
+    uint64_t section_count;
+    // Checksum of the header (with this field set to 0) and section table
+    uint64_t checksum;
+};
+
+struct SnapshotSection {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+// Order of the sections in a snapshot, attribute columns follow the
+// attribute names in the order they are listed
+enum SnapshotSectionIndex {
+    offsets_section,
+    targets_section,
+    label_offsets_section,
+    label_chars_section,
+    label_order_section,
+    attribute_names_section,
+    first_attribute_section
+};
+
+// Return a 64-bit checksum of a buffer, consumed a word at a time
+inline uint64_t checksum(const void* data, size_t size,
+                         uint64_t hash = 0xcbf29ce484222325ull) {
+    const char* bytes = static_cast<const char*>(data);
+    const uint64_t prime = 0x100000001b3ull;
+    hash ^= size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, size - i);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+inline uint64_t align_up(uint64_t value) {
+    return (value + snapshot_alignment - 1) & ~(snapshot_alignment - 1);
+}
+}  // namespace detail
+
+class ConcurrentGraphBuilder;
+class GraphView;
+
+// Contiguous range of neighbor ids
+struct NeighborRange {
+    const NodeId* first;
+    const NodeId* last;
+
+    inline const NodeId* begin() const { return first; }
+
+    inline const NodeId* end() const { return last; }
+
+    inline size_t size() const { return (size_t)(last - first); }
+};
+
+// Read-only graph stored as compressed sparse rows. The neighbors of node i
+// are targets[offsets[i]] up to targets[offsets[i + 1]]. Arrays are either
+// owned by the graph or used in place from a mapped snapshot file, and copies
+// share the same arrays.
+class CSRGraph {
+   public:
+    CSRGraph() : CSRGraph(std::make_shared<Arrays>(), 0, false) {}
+
+    // Construct from a graph, copying its adjacency, labels and attributes
+    explicit CSRGraph(const Graph& g)
+        : CSRGraph(from_graph(g), g.number_of_edges(), g.directed()) {}
+
+    // Construct from caller supplied CSR arrays without copying them, nodes are
+    // labelled by their id. The arrays must stay valid while the graph or any
+    // copy of it is in use, which can be ensured by passing their owner. An
+    // undirected graph must list each edge in the rows of both of its nodes
+    // and each self loop once.
+    CSRGraph(size_t nodes, const uint64_t* offsets, const NodeId* targets,
+             bool directed, std::shared_ptr<const void> owner = nullptr)
+        : CSRGraph() {
+        nodes_ = nodes;
+        entries_ = offsets[nodes];
+        directed_ = directed;
+        offsets_ = offsets;
+        targets_ = targets;
+        storage_ = owner;
+        edges_ = count_edges();
+    }
+
+    // Construct from CSR arrays, taking ownership of them
+    CSRGraph(std::vector<uint64_t> offsets, std::vector<NodeId> targets,
+             bool directed)
+        : CSRGraph() {
+        auto arrays = std::make_shared<Arrays>();
+        arrays->offsets = std::move(offsets);
+        arrays->targets = std::move(targets);
+        if (arrays->offsets.empty() ||
+            arrays->offsets.back() != arrays->targets.size()) {
+            throw GraphwError("Offsets do not match number of targets");
+        }
+        *this = CSRGraph(arrays->offsets.size() - 1, arrays->offsets.data(),
+                         arrays->targets.data(), directed, arrays);
+    }
+
+    // Construct from an edge list given as coordinate (COO) arrays of count
+    // row and column ids, nodes are labelled by their id. Entries are grouped
+    // by row with a counting sort, keeping their order within each row. In an
+    // undirected graph each entry is also added to the row of its column.
+    static CSRGraph from_coo(size_t nodes, const NodeId* rows,
+                             const NodeId* columns, size_t count,
+                             bool directed) {
+        auto arrays = std::make_shared<Arrays>();
+        arrays->offsets.assign(nodes + 1, 0);
+        for (size_t k = 0; k < count; k++) {
+            if (rows[k] < 0 || (size_t)(rows[k]) >= nodes || columns[k] < 0 ||
+                (size_t)(columns[k]) >= nodes) {
+                throw GraphwError(
+                    "Node id out of range: " +
+                    std::to_string(std::max(rows[k], columns[k])));
+            }
+            arrays->offsets[rows[k] + 1]++;
+            if (!directed && rows[k] != columns[k]) {
+                arrays->offsets[columns[k] + 1]++;
+            }
+        }
+        for (size_t i = 0; i < nodes; i++) {
+            arrays->offsets[i + 1] += arrays->offsets[i];
+        }
+        arrays->targets.resize(arrays->offsets[nodes]);
+        std::vector<uint64_t> next(arrays->offsets.begin(),
+                                   arrays->offsets.end() - 1);
+        for (size_t k = 0; k < count; k++) {
+            arrays->targets[next[rows[k]]++] = columns[k];
+            if (!directed && rows[k] != columns[k]) {
+                arrays->targets[next[columns[k]]++] = rows[k];
+            }
+        }
+        return CSRGraph(nodes, arrays->offsets.data(), arrays->targets.data(),
+                        directed, arrays);
+    }
+
+    // Load a snapshot written by write_snapshot. The file is mapped and its
+    // arrays are used in place. Section sizes and the end offsets are always
+    // checked, section checksums and the contents of the offset, neighbor and
+    // label arrays only if verify is set, since that requires reading the
+    // whole file.
+    static CSRGraph load_snapshot(const std::string& path,
+                                  bool verify = false) {
+        auto file = std::make_shared<detail::MappedFile>(path, false);
+        const char* data = file->data();
+        const uint64_t size = file->size();
+        detail::SnapshotHeader header;
+        if (size < sizeof(header)) {
+            throw GraphwError("Invalid snapshot: " + path);
+        }
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, detail::snapshot_magic, 8) != 0) {
+            throw GraphwError("Invalid snapshot: " + path);
+        }
+        if (header.byte_order != detail::snapshot_byte_order) {
+            throw GraphwError("Snapshot was written on an incompatible "
+                              "platform: " +
+                              path);
+        }
+        if (header.id_size != sizeof(NodeId)) {
+            throw GraphwError("Snapshot was written with " +
+                              std::to_string(header.id_size * 8) +
+                              "-bit ids: " + path);
+        }
+        if (header.version != detail::snapshot_version) {
+            throw GraphwError("Unsupported snapshot version " +
+                              std::to_string(header.version) + ": " + path);
+        }
+        if (header.section_count < detail::first_attribute_section ||
+            header.section_count > size / sizeof(detail::SnapshotSection) ||
+            header.nodes > size || header.entries > size) {
+            throw GraphwError("Invalid snapshot: " + path);
+        }
+        const uint64_t table_size =
+            header.section_count * sizeof(detail::SnapshotSection);
+        if (sizeof(header) + table_size > size) {
+            throw GraphwError("Invalid snapshot: " + path);
+        }
+        std::vector<detail::SnapshotSection> sections(header.section_count);
+        memcpy(sections.data(), data + sizeof(header), table_size);
+        uint64_t expected_checksum = header.checksum;
+        header.checksum = 0;
+        uint64_t header_checksum =
+            detail::checksum(sections.data(), table_size,
+                             detail::checksum(&header, sizeof(header)));
+        if (header_checksum != expected_checksum) {
+            throw GraphwError("Snapshot header checksum mismatch: " + path);
+        }
+        // Check that every section is aligned, inside the file and sized as
+        // the header implies
+        bool labels = header.flags & detail::snapshot_labels;
+        for (size_t i = 0; i < sections.size(); i++) {
+            const detail::SnapshotSection& section = sections[i];
+            uint64_t expected = section.size;
+            if (i == detail::offsets_section) {
+                expected = (header.nodes + 1) * sizeof(uint64_t);
+            } else if (i == detail::targets_section) {
+                expected = header.entries * sizeof(NodeId);
+            } else if (i == detail::label_offsets_section) {
+                expected = labels ? (header.nodes + 1) * sizeof(uint64_t) : 0;
+            } else if (i == detail::label_order_section) {
+                expected = labels ? header.nodes * sizeof(NodeId) : 0;
+            } else if (i >= detail::first_attribute_section) {
+                expected = header.nodes * sizeof(double);
+            }
+            if (section.size != expected ||
+                section.offset % sizeof(uint64_t) != 0 ||
+                section.offset > size || section.size > size - section.offset) {
+                throw GraphwError("Invalid snapshot: " + path);
+            }
+            if (verify && detail::checksum(data + section.offset,
+                                           section.size) != section.checksum) {
+                throw GraphwError("Snapshot checksum mismatch: " + path);
+            }
+        }
+        CSRGraph g;
+        g.storage_ = file;
+        g.nodes_ = header.nodes;
+        g.entries_ = header.entries;
+        g.edges_ = (EdgeCount)(header.edges);
+        g.directed_ = header.flags & detail::snapshot_directed;
+        auto section_data = [&](size_t i) {
+            return data + sections[i].offset;
+        };
+        g.offsets_ = reinterpret_cast<const uint64_t*>(
+            section_data(detail::offsets_section));
+        g.targets_ = reinterpret_cast<const NodeId*>(
+            section_data(detail::targets_section));
+        if (labels) {
+            g.label_offsets_ = reinterpret_cast<const uint64_t*>(
+                section_data(detail::label_offsets_section));
+            g.label_chars_ = section_data(detail::label_chars_section);
+            g.label_order_ = reinterpret_cast<const NodeId*>(
+                section_data(detail::label_order_section));
+        }
+        // Attribute names are stored as consecutive null terminated strings
+        std::string_view names(
+            section_data(detail::attribute_names_section),
+            sections[detail::attribute_names_section].size);
+        size_t name_start = 0;
+        for (size_t i = detail::first_attribute_section; i < sections.size();
+             i++) {
+            size_t name_end = names.find('\0', name_start);
+            if (name_end == std::string_view::npos) {
+                throw GraphwError("Invalid snapshot: " + path);
+            }
+            g.attribute_names_.emplace_back(
+                names.substr(name_start, name_end - name_start));
+            g.attribute_columns_.push_back(
+                reinterpret_cast<const double*>(section_data(i)));
+            name_start = name_end + 1;
+        }
+        // The first and last offsets bound every row and label, the arrays in
+        // between are only checked if verify is set
+        if (g.offsets_[0] != 0 || g.offsets_[g.nodes_] != g.entries_) {
+            throw GraphwError("Invalid snapshot: " + path);
+        }
+        if (labels && (g.label_offsets_[0] != 0 ||
+                       g.label_offsets_[g.nodes_] !=
+                           sections[detail::label_chars_section].size)) {
+            throw GraphwError("Invalid snapshot: " + path);
+        }
+        if (verify && !g.valid_arrays()) {
+            throw GraphwError("Invalid snapshot: " + path);
+        }
+        return g;
+    }
+
+    // Write the graph to a file in the snapshot format
+    void write_snapshot(const std::string& path) const {
+        std::string names;
+        for (auto const& name : attribute_names_) {
+            names += name;
+            names += '\0';
+        }
+        // Data and size of every section in order
+        std::vector<std::pair<const void*, uint64_t> > contents;
+        contents.emplace_back(offsets_, (nodes_ + 1) * sizeof(uint64_t));
+        contents.emplace_back(targets_, entries_ * sizeof(NodeId));
+        if (has_labels()) {
+            contents.emplace_back(label_offsets_,
+                                  (nodes_ + 1) * sizeof(uint64_t));
+            contents.emplace_back(label_chars_, label_offsets_[nodes_]);
+            contents.emplace_back(label_order_, nodes_ * sizeof(NodeId));
+        } else {
+            contents.emplace_back(nullptr, 0);
+            contents.emplace_back(nullptr, 0);
+            contents.emplace_back(nullptr, 0);
+        }
+        contents.emplace_back(names.data(), names.size());
+        for (auto const& column : attribute_columns_) {
+            contents.emplace_back(column, nodes_ * sizeof(double));
+        }
+        std::vector<detail::SnapshotSection> sections;
+        uint64_t offset = detail::align_up(
+            sizeof(detail::SnapshotHeader) +
+            (contents.size() * sizeof(detail::SnapshotSection)));
+        for (auto const& content : contents) {
+            // Empty sections take no space in the file
+            sections.push_back(
+                {content.second > 0 ? offset : 0, content.second,
+                 detail::checksum(content.first, content.second)});
+            if (content.second > 0) {
+                offset = detail::align_up(offset + content.second);
+            }
+        }
+        detail::SnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, detail::snapshot_magic, 8);
+        header.version = detail::snapshot_version;
+        header.byte_order = detail::snapshot_byte_order;
+        header.flags = (directed_ ? detail::snapshot_directed : 0) |
+                       (has_labels() ? detail::snapshot_labels : 0);
+        header.id_size = sizeof(NodeId);
+        header.nodes = nodes_;
+        header.entries = entries_;
+        header.edges = (uint64_t)(edges_);
+        header.section_count = sections.size();
+        header.checksum = detail::checksum(
+            sections.data(), sections.size() * sizeof(detail::SnapshotSection),
+            detail::checksum(&header, sizeof(header)));
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(sections.data()),
+                   sections.size() * sizeof(detail::SnapshotSection));
+        uint64_t position =
+            sizeof(header) + sections.size() * sizeof(detail::SnapshotSection);
+        const char padding[detail::snapshot_alignment] = {};
+        for (size_t i = 0; i < contents.size(); i++) {
+            if (contents[i].second > 0) {
+                file.write(padding, sections[i].offset - position);
+                file.write(static_cast<const char*>(contents[i].first),
+                           contents[i].second);
+                position = sections[i].offset + contents[i].second;
+            }
+        }
+        if (!file) {
+            throw GraphwError("Could not write snapshot: " + path);
+        }
+    }
+
+    // Return whether graph is directed
+    inline bool directed() const { return directed_; }
+
+    // Return number of nodes
+    inline NodeId number_of_nodes() const { return (NodeId)(nodes_); }
+
+    // Return number of edges
+    inline EdgeCount number_of_edges() const { return edges_; }
+
+    // Return whether nodes have labels, nodes without labels are labelled by
+    // their id
+    inline bool has_labels() const { return label_offsets_ != nullptr; }
+
+    // Return the neighbor ids of the node with given id
+    inline NeighborRange neighbors(NodeId id) const {
+        return {targets_ + offsets_[id], targets_ + offsets_[id + 1]};
+    }
+
+    // Return the label of the node with given id
+    std::string label(NodeId id) const {
+        if (!has_labels()) {
+            return std::to_string(id);
+        }
+        return std::string(label_view(id));
+    }
+
+    // Return the id of the node with given label
+    NodeId id(const std::string& label) const {
+        NodeId node_id = find(label);
+        if (node_id < 0) {
+            // Label does not exist
+            throw GraphwError("Given label does not exist");
+        }
+        return node_id;
+    }
+
+    // Return the density of the graph
+    float density() const {
+        float size = (float)(nodes_);
+        if (directed_) {
+            return (float)(edges_ / (size * (size - 1)));
+        }
+        return (float)((2 * edges_) / (size * (size - 1)));
+    }
+
+    // Return the degree of a node with given label
+    EdgeCount degree(const std::string& label) const {
+        return (EdgeCount)(neighbors(id(label)).size());
+    }
+
+    // Return the average degree of the graph
+    float average_degree() const {
+        return ((float)entries_ / (float)nodes_);
+    }
+
+    // Return a list of labels representing the neighbor of a given node label
+    std::list<std::string> get_neighbors(const std::string& label) const {
+        std::list<std::string> neighbors_list;
+        for (NodeId neighbor_id : neighbors(id(label))) {
+            neighbors_list.push_back(this->label(neighbor_id));
+        }
+        return neighbors_list;
+    }
+
+    // Return the adjacency list in the format of Graph::get_adjacency_list
+    std::string get_adjacency_list(const std::string& delimiter = " ") const {
+        std::string adjacency_list;
+        for (size_t i = 0; i < nodes_; i++) {
+            adjacency_list += label(i);
+            adjacency_list += delimiter;
+            for (NodeId neighbor_id : neighbors(i)) {
+                adjacency_list += label(neighbor_id);
+                adjacency_list += delimiter;
+            }
+            adjacency_list += '\n';
+        }
+        return adjacency_list;
+    }
+
+    // Return the names of the attributes in the graph
+    inline const std::vector<std::string>& attribute_names() const {
+        return attribute_names_;
+    }
+
+    // Return the values of an attribute indexed by node id
+    const double* attribute_column(const std::string& name) const {
+        auto it =
+            std::find(attribute_names_.begin(), attribute_names_.end(), name);
+        if (it == attribute_names_.end()) {
+            throw GraphwError("Given attribute does not exist");
+        }
+        return attribute_columns_[it - attribute_names_.begin()];
+    }
+
+    // Return a numeric attribute of the node with given label
+    double attribute(const std::string& name, const std::string& label) const {
+        return attribute_column(name)[id(label)];
+    }
+
+   protected:
+    friend class ConcurrentGraphBuilder;
+    friend class GraphView;
+
+    // Arrays backing a graph which owns its storage
+    struct Arrays {
+        std::vector<uint64_t> offsets;
+        std::vector<NodeId> targets;
+        std::vector<uint64_t> label_offsets;
+        std::string label_chars;
+        std::vector<NodeId> label_order;
+        std::vector<std::string> attribute_names;
+        std::vector<std::vector<double> > attribute_columns;
+    };
+
+    size_t nodes_;
+    size_t entries_;
+    EdgeCount edges_;
+    bool directed_;
+    const uint64_t* offsets_;
+    const NodeId* targets_;
+    const uint64_t* label_offsets_;
+    const char* label_chars_;
+    // Node ids sorted by label for lookups
+    const NodeId* label_order_;
+    std::vector<std::string> attribute_names_;
+    std::vector<const double*> attribute_columns_;
+    // Keeps owned arrays or the mapped file alive
+    std::shared_ptr<const void> storage_;
+
+    CSRGraph(std::shared_ptr<Arrays> arrays, EdgeCount new_edges_,
+             bool new_directed_)
+        : edges_(new_edges_),
+          directed_(new_directed_),
+          label_offsets_(nullptr),
+          label_chars_(nullptr),
+          label_order_(nullptr) {
+        if (arrays->offsets.empty()) {
+            arrays->offsets.push_back(0);
+        }
+        nodes_ = arrays->offsets.size() - 1;
+        entries_ = arrays->targets.size();
+        offsets_ = arrays->offsets.data();
+        targets_ = arrays->targets.data();
+        if (!arrays->label_offsets.empty()) {
+            label_offsets_ = arrays->label_offsets.data();
+            label_chars_ = arrays->label_chars.data();
+            label_order_ = arrays->label_order.data();
+        }
+        attribute_names_ = arrays->attribute_names;
+        for (auto const& column : arrays->attribute_columns) {
+            attribute_columns_.push_back(column.data());
+        }
+        storage_ = arrays;
+    }
+
+    // Return the arrays of a graph
+    static std::shared_ptr<Arrays> from_graph(const Graph& g) {
+        auto arrays = std::make_shared<Arrays>();
+        size_t nodes = g.number_of_nodes();
+        arrays->offsets.resize(nodes + 1);
+        arrays->label_offsets.resize(nodes + 1);
+        arrays->label_order.resize(nodes);
+        arrays->offsets[0] = 0;
+        arrays->label_offsets[0] = 0;
+        for (size_t i = 0; i < nodes; i++) {
+            arrays->offsets[i + 1] = arrays->offsets[i] + g.graph[i].size();
+            arrays->label_offsets[i + 1] =
+                arrays->label_offsets[i] + g.label(i).size();
+            arrays->label_order[i] = (NodeId)(i);
+        }
+        arrays->targets.reserve(arrays->offsets[nodes]);
+        arrays->label_chars.reserve(arrays->label_offsets[nodes]);
+        for (size_t i = 0; i < nodes; i++) {
+            for (auto const& neighbor : g.graph[i]) {
+                arrays->targets.push_back(neighbor.id);
+            }
+            arrays->label_chars += g.label(i);
+        }
+        std::sort(arrays->label_order.begin(), arrays->label_order.end(),
+                  [&g](NodeId id1, NodeId id2) {
+                      return g.label(id1) < g.label(id2);
+                  });
+        arrays->attribute_names = g.attribute_names();
+        for (auto const& name : arrays->attribute_names) {
+            arrays->attribute_columns.push_back(g.attribute_column(name));
+        }
+        return arrays;
+    }
+
+    // Return the number of edges represented by the arrays. Undirected edges
+    // are listed on both of their nodes except for self loops.
+    EdgeCount count_edges() const {
+        if (offsets_[0] != 0) {
+            throw GraphwError("First offset must be 0");
+        }
+        size_t loops = 0;
+        for (size_t i = 0; i < nodes_; i++) {
+            if (offsets_[i + 1] < offsets_[i]) {
+                throw GraphwError("Offsets must not decrease");
+            }
+            for (NodeId neighbor_id : neighbors(i)) {
+                if (neighbor_id < 0 || (size_t)(neighbor_id) >= nodes_) {
+                    throw GraphwError("Node id out of range: " +
+                                      std::to_string(neighbor_id));
+                }
+                loops += (size_t)(neighbor_id) == i;
+            }
+        }
+        return (EdgeCount)(directed_ ? entries_
+                                     : ((entries_ - loops) / 2) + loops);
+    }
+
+    // Return whether offsets do not decrease and every target and label order
+    // entry is a node id. The end offsets must have been checked already.
+    bool valid_arrays() const {
+        for (size_t i = 0; i < nodes_; i++) {
+            if (offsets_[i + 1] < offsets_[i]) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < entries_; i++) {
+            if (targets_[i] < 0 || (size_t)(targets_[i]) >= nodes_) {
+                return false;
+            }
+        }
+        if (!has_labels()) {
+            return true;
+        }
+        for (size_t i = 0; i < nodes_; i++) {
+            if (label_offsets_[i + 1] < label_offsets_[i] ||
+                label_order_[i] < 0 || (size_t)(label_order_[i]) >= nodes_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Return the label of a labelled node without copying it
+    inline std::string_view label_view(NodeId id) const {
+        return std::string_view(label_chars_ + label_offsets_[id],
+                                label_offsets_[id + 1] - label_offsets_[id]);
+    }
+
+    // Return the id of the node with given label or -1 if it does not exist
+    NodeId find(std::string_view label) const {
+        if (!has_labels()) {
+            NodeId node_id = -1;
+            auto result =
+                std::from_chars(label.data(), label.data() + label.size(),
+                                node_id);
+            if (result.ec != std::errc() ||
+                result.ptr != label.data() + label.size() || node_id < 0 ||
+                (size_t)(node_id) >= nodes_ ||
+                std::to_string(node_id) != label) {
+                return -1;
+            }
+            return node_id;
+        }
+        const NodeId* it = std::lower_bound(
+            label_order_, label_order_ + nodes_, label,
+            [this](NodeId node_id, std::string_view value) {
+                return label_view(node_id) < value;
+            });
+        if (it == label_order_ + nodes_ || label_view(*it) != label) {
+            return -1;
+        }
+        return *it;
+    }
+};
+}  // namespace graphw
+#endif
@@ -8,25 +8,14 @@
 #include <time.h>
 
 #include <algorithm>
-#include <cmath>
-#include <limits>
 #include <set>
 #include <string>
 #include <utility>
 
 #include "graphw.hpp"
+#include "graphw_layout.hpp"
 
 namespace graphw {
-struct Position {
-    int x;
-    int y;
-};
-
-struct PositionFloat {
-    float x;
-    float y;
-};
-
 struct Color {
     uint8_t red;
     uint8_t green;
@@ -52,6 +41,9 @@ SDL_Renderer *renderer = nullptr;
 Color background_color = {0xFF, 0xFF, 0xFF};
 Color edge_color = {0x00, 0x00, 0x00};
 Color node_color = {0x00, 0x00, 0x00};
+// Texture of the outline of a node circle and its radius
+SDL_Texture *circle_texture = nullptr;
+int circle_texture_radius = -1;
 
 // Initialize SDL2
 void init(bool resizable, int width = window_width,
@@ -83,6 +75,11 @@ void close() {
         SDL_FreeSurface(surface);
         save_as_bmp = false;
     }
+    if (circle_texture != nullptr) {
+        SDL_DestroyTexture(circle_texture);
+        circle_texture = nullptr;
+        circle_texture_radius = -1;
+    }
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     renderer = nullptr;
@@ -108,8 +105,16 @@ void set_save(const std::string &file_path) {
     bmp_file_path = file_path;
 }
 
-// Draws a circle given center x, center y, and radius
-void draw_circle(int cx, int cy, int radius) {
+// Return the offsets from the center of the pixels of a circle outline with
+// given radius, which are cached for the last radius
+const std::vector<SDL_Point> &circle_points(int radius) {
+    static std::vector<SDL_Point> points;
+    static int points_radius = -1;
+    if (radius == points_radius) {
+        return points;
+    }
+    points.clear();
+    points_radius = radius;
     int x = radius - 1;
     int y = 0;
     int tx = 1;
@@ -119,7 +124,7 @@ void draw_circle(int cx, int cy, int radius) {
         int dx[8] = {x, x, -x, -x, y, y, -y, -y};
         int dy[8] = {-y, y, -y, y, -x, x, -x, x};
         for (int k = 0; k < 8; k++) {
-            SDL_RenderDrawPoint(renderer, cx + dx[k], cy + dy[k]);
+            points.push_back({dx[k], dy[k]});
         }
         if (error <= 0) {
             y++;
@@ -132,6 +137,217 @@ void draw_circle(int cx, int cy, int radius) {
             error += tx - (radius * 2);
         }
     }
+    return points;
+}
+
+// Primitives are collected in batches which are reused across frames and
+// submitted to the renderer in one call per batch_size primitives, so a
+// frame costs a few calls however many nodes and edges it has
+const size_t batch_size = 16384;
+std::vector<SDL_Point> point_batch;
+
+// Submit the batched points in given color
+void flush_points(const Color &color) {
+    if (point_batch.empty()) {
+        return;
+    }
+    SDL_SetRenderDrawColor(renderer, color.red, color.green, color.blue, 0xFF);
+    SDL_RenderDrawPoints(renderer, point_batch.data(),
+                         (int)(point_batch.size()));
+    point_batch.clear();
+}
+
+// Add a point to the batch of points drawn in given color
+void batch_point(int x, int y, const Color &color) {
+    point_batch.push_back({x, y});
+    if (point_batch.size() >= batch_size * 8) {
+        flush_points(color);
+    }
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+// Nodes and edges are drawn as quads with SDL_RenderGeometry, nodes from a
+// texture of their circle outline
+#define GRAPHW_RENDER_GEOMETRY
+// Vertices of quads and indices of their triangles
+struct QuadBatch {
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+QuadBatch node_batch;
+QuadBatch line_batch;
+
+// Return a texture with the white outline of a circle of given radius around
+// its center pixel on a transparent background, which is cached for the last
+// radius until SDL2 is closed
+SDL_Texture *node_texture(int radius) {
+    if (circle_texture != nullptr && radius == circle_texture_radius) {
+        return circle_texture;
+    }
+    if (circle_texture != nullptr) {
+        SDL_DestroyTexture(circle_texture);
+    }
+    int size = (2 * radius) + 1;
+    std::vector<uint32_t> pixels(size * size, 0x00000000);
+    for (const SDL_Point &point : circle_points(radius)) {
+        pixels[((point.y + radius) * size) + point.x + radius] = 0xFFFFFFFF;
+    }
+    circle_texture =
+        SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                          SDL_TEXTUREACCESS_STATIC, size, size);
+    SDL_UpdateTexture(circle_texture, NULL, pixels.data(),
+                      size * (int)(sizeof(uint32_t)));
+    SDL_SetTextureBlendMode(circle_texture, SDL_BLENDMODE_BLEND);
+    circle_texture_radius = radius;
+    return circle_texture;
+}
+
+// Submit a batch of quads with given texture
+void flush_quads(QuadBatch &batch, SDL_Texture *texture) {
+    if (batch.vertices.empty()) {
+        return;
+    }
+    SDL_RenderGeometry(renderer, texture, batch.vertices.data(),
+                       (int)(batch.vertices.size()), batch.indices.data(),
+                       (int)(batch.indices.size()));
+    batch.vertices.clear();
+    batch.indices.clear();
+}
+
+// Add a quad with given corners in order around it and texture coordinates
+// to a batch of quads drawn with texture
+void batch_quad(QuadBatch &batch, const SDL_FPoint (&corners)[4],
+                const SDL_FPoint (&tex_coords)[4], const Color &color,
+                SDL_Texture *texture) {
+    int first = (int)(batch.vertices.size());
+    for (int k = 0; k < 4; k++) {
+        batch.vertices.push_back(
+            {corners[k], {color.red, color.green, color.blue, 0xFF},
+             tex_coords[k]});
+    }
+    const int triangles[6] = {0, 1, 2, 0, 2, 3};
+    for (int index : triangles) {
+        batch.indices.push_back(first + index);
+    }
+    if (batch.vertices.size() >= batch_size * 4) {
+        flush_quads(batch, texture);
+    }
+}
+#endif
+
+// Add a node circle to the batch of nodes
+void batch_node(int cx, int cy, int radius) {
+#ifdef GRAPHW_RENDER_GEOMETRY
+    SDL_Texture *texture = node_texture(radius);
+    float left = (float)(cx - radius);
+    float top = (float)(cy - radius);
+    float right = (float)(cx + radius + 1);
+    float bottom = (float)(cy + radius + 1);
+    batch_quad(node_batch,
+               {{left, top}, {right, top}, {right, bottom}, {left, bottom}},
+               {{0, 0}, {1, 0}, {1, 1}, {0, 1}}, node_color, texture);
+#else
+    for (const SDL_Point &point : circle_points(radius)) {
+        batch_point(cx + point.x, cy + point.y, node_color);
+    }
+#endif
+}
+
+// Draw the batched nodes
+void flush_nodes(int radius) {
+#ifdef GRAPHW_RENDER_GEOMETRY
+    flush_quads(node_batch, node_texture(radius));
+#else
+    flush_points(node_color);
+#endif
+}
+
+#ifndef GRAPHW_RENDER_GEOMETRY
+// Pixels of the batched lines and their color
+std::vector<SDL_Point> line_points;
+Color line_color;
+#endif
+
+// Draw the batched lines
+void flush_lines() {
+#ifdef GRAPHW_RENDER_GEOMETRY
+    flush_quads(line_batch, nullptr);
+#else
+    if (line_points.empty()) {
+        return;
+    }
+    SDL_SetRenderDrawColor(renderer, line_color.red, line_color.green,
+                           line_color.blue, 0xFF);
+    SDL_RenderDrawPoints(renderer, line_points.data(),
+                         (int)(line_points.size()));
+    line_points.clear();
+#endif
+}
+
+// Add a line in given color to the batch of lines, as a quad one pixel wide
+// which covers the pixels of its ends, or as its pixels without
+// SDL_RenderGeometry
+void batch_line(int x1, int y1, int x2, int y2, const Color &color) {
+#ifdef GRAPHW_RENDER_GEOMETRY
+    float dx = (float)(x2 - x1);
+    float dy = (float)(y2 - y1);
+    float length = sqrt((dx * dx) + (dy * dy));
+    if (length == 0) {
+        batch_quad(line_batch,
+                   {{x1 + 0.0f, y1 + 0.0f},
+                    {x1 + 1.0f, y1 + 0.0f},
+                    {x1 + 1.0f, y1 + 1.0f},
+                    {x1 + 0.0f, y1 + 1.0f}},
+                   {{0, 0}, {0, 0}, {0, 0}, {0, 0}}, color, nullptr);
+        return;
+    }
+    // Half a pixel along and across the line
+    float along_x = (dx / length) * 0.5f;
+    float along_y = (dy / length) * 0.5f;
+    float normal_x = -along_y;
+    float normal_y = along_x;
+    float start_x = x1 + 0.5f - along_x;
+    float start_y = y1 + 0.5f - along_y;
+    float end_x = x2 + 0.5f + along_x;
+    float end_y = y2 + 0.5f + along_y;
+    batch_quad(line_batch,
+               {{start_x + normal_x, start_y + normal_y},
+                {end_x + normal_x, end_y + normal_y},
+                {end_x - normal_x, end_y - normal_y},
+                {start_x - normal_x, start_y - normal_y}},
+               {{0, 0}, {0, 0}, {0, 0}, {0, 0}}, color, nullptr);
+#else
+    // Rasterize the line into the batch of points with Bresenham's algorithm,
+    // which gives the pixels of SDL_RenderDrawLine, flushing points of
+    // another color first
+    if (!line_points.empty() && !(color == line_color)) {
+        flush_lines();
+    }
+    line_color = color;
+    int dx = abs(x2 - x1);
+    int dy = -abs(y2 - y1);
+    int step_x = x1 < x2 ? 1 : -1;
+    int step_y = y1 < y2 ? 1 : -1;
+    int error = dx + dy;
+    while (true) {
+        line_points.push_back({x1, y1});
+        if (x1 == x2 && y1 == y2) {
+            break;
+        }
+        int error2 = 2 * error;
+        if (error2 >= dy) {
+            error += dy;
+            x1 += step_x;
+        }
+        if (error2 <= dx) {
+            error += dx;
+            y1 += step_y;
+        }
+    }
+    if (line_points.size() >= batch_size * 8) {
+        flush_lines();
+    }
+#endif
 }
 
 void set_window_title(ArcDiagram &ad) {
@@ -154,47 +370,71 @@ void set_window_title(ForceDirectedLayout &fdl) {
     SDL_SetWindowTitle(window, "Force Directed Layout");
 }
 
+void set_window_title(MultilevelForceDirectedLayout &ml) {
+    SDL_SetWindowTitle(window, "Multilevel Force Directed Layout");
+}
+
+// Draw nodes at given positions and a straight line for each edge
+std::vector<Position> draw_positions(
+    const Graph &g, const std::vector<PositionFloat> &positions,
+    int node_radius) {
+    std::vector<Position> node_positions;
+    node_positions.reserve(positions.size());
+    for (const PositionFloat &position : positions) {
+        int node_x = (int)(position.x);
+        int node_y = (int)(position.y);
+        batch_node(node_x, node_y, node_radius);
+        node_positions.push_back({node_x, node_y});
+    }
+    flush_nodes(node_radius);
+    // Draw edges
+    for (NodeId i = 0; i < g.graph.size(); i++) {
+        for (int j = 0; j < g.graph[i].size(); j++) {
+            // Draw edge (line) from node i to j
+            NodeId node1_id = i;
+            NodeId node2_id = g.graph[i][j].id;
+            batch_line(node_positions[node1_id].x, node_positions[node1_id].y,
+                       node_positions[node2_id].x, node_positions[node2_id].y,
+                       edge_color);
+        }
+    }
+    flush_lines();
+    return node_positions;
+}
+
 // Render an Arc Diagram graph
 std::vector<Position> render(ArcDiagram &ad) {
     std::vector<Position> node_positions;
-    // Initialize checkpoint positions and measurements
-    int center_x = (int)(window_width / 2);
+    std::vector<PositionFloat> positions =
+        compute_layout(ad, window_width, window_height);
     int center_y = (int)(window_height / 2);
-    int node_radius = (int)((window_width / (ad.number_of_nodes() * 2)) / 2);
+    int node_radius = arc_node_radius(ad, window_width);
     // Draw line and node circles
-    SDL_SetRenderDrawColor(renderer, node_color.red, node_color.green,
-                           node_color.blue, 0xFF);
-    for (int i = 0; i <= ad.number_of_nodes(); i++) {
-        if (i < ad.number_of_nodes()) {
-            int node_x = (node_radius * 2) + (i * (4 * node_radius));
-            int node_y = center_y;
-            node_positions.push_back({node_x, node_y});
-            draw_circle(node_x, node_y, node_radius);
-        }
-        if (i != 0 && i != ad.number_of_nodes()) {
-            int start_x =
-                (int)(((4 * node_radius) * (i - 1)) + (3 * node_radius));
-            SDL_RenderDrawLine(renderer, start_x, center_y,
-                               (int)(start_x + (2 * node_radius)), center_y);
+    for (NodeId i = 0; i < ad.number_of_nodes(); i++) {
+        int node_x = (int)(positions[i].x);
+        node_positions.push_back({node_x, center_y});
+        batch_node(node_x, center_y, node_radius);
+        if (i != 0) {
+            int start_x = node_x - (3 * node_radius);
+            batch_line(start_x, center_y, (int)(start_x + (2 * node_radius)),
+                       center_y, node_color);
         }
     }
+    flush_nodes(node_radius);
+    flush_lines();
     // Draw edges
-    std::set<std::pair<int, int> > edges;
+    std::set<std::pair<NodeId, NodeId> > edges;
     int current_edge = 0;
-    SDL_SetRenderDrawColor(renderer, edge_color.red, edge_color.green,
-                           edge_color.blue, 0xFF);
-    for (int i = 0; i < ad.graph.size(); i++) {
+    for (NodeId i = 0; i < ad.graph.size(); i++) {
         for (int j = 0; j < ad.graph[i].size(); j++) {
             // Draw edge from node i to j
-            int node1_id = i;
-            int node2_id = (int)(ad.graph[i][j].id);
-            int node1_x =
-                (int)(((4 * node_radius) * node1_id) + (2 * node_radius));
-            int node2_x =
-                (int)(((4 * node_radius) * node2_id) + (2 * node_radius));
+            NodeId node1_id = i;
+            NodeId node2_id = ad.graph[i][j].id;
+            int node1_x = node_positions[node1_id].x;
+            int node2_x = node_positions[node2_id].x;
             if (!ad.directed()) {
-                int min_node = std::min(node1_id, node2_id);
-                int max_node = std::max(node1_id, node2_id);
+                NodeId min_node = std::min(node1_id, node2_id);
+                NodeId max_node = std::max(node1_id, node2_id);
                 if (!edges.insert(std::make_pair(min_node, max_node)).second) {
                     // Edge has already been drawn
                     continue;
@@ -217,7 +457,7 @@ std::vector<Position> render(ArcDiagram &ad) {
                 for (int k = 0; k < 8; k++) {
                     if ((above && (cy + dy[k] >= cy)) ||
                         (!above && (cy + dy[k] <= cy))) {
-                        SDL_RenderDrawPoint(renderer, cx + dx[k], cy + dy[k]);
+                        batch_point(cx + dx[k], cy + dy[k], edge_color);
                     }
                 }
                 if (error <= 0) {
@@ -234,317 +474,64 @@ std::vector<Position> render(ArcDiagram &ad) {
             current_edge++;
         }
     }
+    flush_points(edge_color);
     return node_positions;
 }
 
-// Render a Circular Layout graph
+// Render a Circular Layout graph, scaling its cached positions to the window
 std::vector<Position> render(CircularLayout &cl) {
-    std::vector<Position> node_positions;
-    const int circle_padding = 5;
-    const int node_radius = cl.node_radius();
-    // Initialize checkpoint positions and measurements
-    int center_x = (int)(window_width / 2);
-    int center_y = (int)(window_height / 2);
-    int circle_radius = (int)((std::min(window_width, window_height) / 2) -
-                              circle_padding - node_radius);
-    // Draw nodes
-    SDL_SetRenderDrawColor(renderer, node_color.red, node_color.green,
-                           node_color.blue, 0xFF);
-    for (int i = 0; i < cl.number_of_nodes(); i++) {
-        float angle = ((float)i / cl.number_of_nodes()) * (2 * M_PI);
-        int node_x = center_x + (circle_radius * cos(angle));
-        int node_y = center_y + (circle_radius * sin(angle));
-        draw_circle(node_x, node_y, node_radius);
-        Position position = {node_x, node_y};
-        node_positions.push_back(position);
-    }
-    // Draw edges
-    SDL_SetRenderDrawColor(renderer, edge_color.red, edge_color.green,
-                           edge_color.blue, 0xFF);
-    for (int i = 0; i < cl.graph.size(); i++) {
-        for (int j = 0; j < cl.graph[i].size(); j++) {
-            // Draw edge (line) from node i to j
-            int node1_id = i;
-            int node2_id = (int)(cl.graph[i][j].id);
-            SDL_RenderDrawLine(renderer, node_positions[node1_id].x,
-                               node_positions[node1_id].y,
-                               node_positions[node2_id].x,
-                               node_positions[node2_id].y);
-        }
-    }
-    return node_positions;
+    return draw_positions(cl, update_layout(cl, window_width, window_height),
+                          cl.node_radius());
 }
 
-// Render a Spiral Layout graph
+// Render a Spiral Layout graph, scaling its cached positions to the window
 std::vector<Position> render(SpiralLayout &sl) {
-    std::vector<Position> node_positions;
-    const int node_radius = sl.node_radius();
-    const float resolution = sl.resolution();
-    const float chord = 1;
-    const float step = sl.equidistant() ? 0.5 : 1.0;
-    // Initialize checkpoint positions and measurements
-    int center_x = (int)(window_width / 2);
-    int center_y = (int)(window_height / 2);
-    int min_dimension = std::min(window_width, window_height);
-    int padding = 4 * node_radius;
-    // Get initial node positions
-    // Store node_positions as pair of floats
-    std::vector<std::pair<float, float> > node_positions_float;
-    if (sl.equidistant()) {
-        // Calculate node positions with equal distances
-        float theta = resolution;
-        for (int i = 0; i <= sl.number_of_nodes(); i++) {
-            float radius = step * theta;
-            theta += chord / radius;
-            float node_x = (cos(theta) * radius);
-            float node_y = (sin(theta) * radius);
-            if (i > 0) {
-                node_positions_float.push_back(std::make_pair(node_x, node_y));
-            }
-        }
-    } else {
-        // Calculate node positions without equal distances
-        float angle = 0.0;
-        float dist = 0.0;
-        float radius = sl.number_of_nodes();
-        while (dist *
-                   sqrt((cos(angle) * cos(angle)) + (sin(angle) * sin(angle))) <
-               radius) {
-            float node_x = (cos(angle) * dist);
-            float node_y = (sin(angle) * dist);
-            node_positions_float.push_back(std::make_pair(node_x, node_y));
-            dist += step;
-            angle += resolution;
-        }
-    }
-    // Get node max coordinate (x or y dependent on window dimensions)
-    float max = 0;
-    for (int i = 0; i < node_positions_float.size(); i++) {
-        float coordinate;
-        if (window_width == min_dimension) {
-            // Window width is smaller than window height
-            // Record absolute x coordinate
-            coordinate = abs(node_positions_float[i].first);
-        } else {
-            // Window height is smaller than window width
-            // Record absolute y coordinate
-            coordinate = abs(node_positions_float[i].second);
-        }
-        max = std::max(coordinate, max);
-    }
-    // Adjust node positions with calculated factor
-    float factor = ((float)(min_dimension - padding) / max) / 2;
-    SDL_SetRenderDrawColor(renderer, node_color.red, node_color.green,
-                           node_color.blue, 0xFF);
-    for (int i = 0; i < node_positions_float.size(); i++) {
-        node_positions_float[i].first =
-            (node_positions_float[i].first * factor) + center_x;
-        node_positions_float[i].second =
-            (node_positions_float[i].second * factor) + center_y;
-        int node_x = node_positions_float[i].first;
-        int node_y = node_positions_float[i].second;
-        node_positions.push_back({node_x, node_y});
-        draw_circle(node_x, node_y, node_radius);
-    }
-    // Draw edges
-    SDL_SetRenderDrawColor(renderer, edge_color.red, edge_color.green,
-                           edge_color.blue, 0xFF);
-    for (int i = 0; i < sl.graph.size(); i++) {
-        for (int j = 0; j < sl.graph[i].size(); j++) {
-            // Draw edge (line) from node i to j
-            int node1_id = i;
-            int node2_id = (int)(sl.graph[i][j].id);
-            SDL_RenderDrawLine(renderer, node_positions_float[node1_id].first,
-                               node_positions_float[node1_id].second,
-                               node_positions_float[node2_id].first,
-                               node_positions_float[node2_id].second);
-        }
-    }
-    return node_positions;
+    return draw_positions(sl, update_layout(sl, window_width, window_height),
+                          sl.node_radius());
 }
 
-// Render Random Layout graph
-std::vector<Position> render(
-    RandomLayout &rl, std::vector<std::pair<float, float> > &random_positions,
-    bool first_render) {
-    std::vector<Position> node_positions;
-    const int node_radius = rl.node_radius();
-    // Draw nodes
-    SDL_SetRenderDrawColor(renderer, node_color.red, node_color.green,
-                           node_color.blue, 0xFF);
-    for (int i = 0; i < rl.number_of_nodes(); i++) {
-        if (first_render) {
-            random_positions.push_back(std::make_pair(
-                (static_cast<float>(rand()) / static_cast<float>(RAND_MAX)),
-                (static_cast<float>(rand()) / static_cast<float>(RAND_MAX))));
-        }
-        int node_x =
-            (int)((random_positions[i].first * (window_width - node_radius)) +
-                  node_radius);
-        int node_y =
-            (int)((random_positions[i].second * (window_height - node_radius)) +
-                  node_radius);
-        draw_circle(node_x, node_y, node_radius);
-        Position position = {node_x, node_y};
-        node_positions.push_back(position);
-    }
-    // Draw edges
-    SDL_SetRenderDrawColor(renderer, edge_color.red, edge_color.green,
-                           edge_color.blue, 0xFF);
-    for (int i = 0; i < rl.graph.size(); i++) {
-        for (int j = 0; j < rl.graph[i].size(); j++) {
-            // Draw edge (line) from node i to j
-            int node1_id = i;
-            int node2_id = (int)(rl.graph[i][j].id);
-            SDL_RenderDrawLine(renderer, node_positions[node1_id].x,
-                               node_positions[node1_id].y,
-                               node_positions[node2_id].x,
-                               node_positions[node2_id].y);
-        }
+// Render Random Layout graph, filling unit positions with random positions on
+// the first render and reusing them afterwards
+std::vector<Position> render(RandomLayout &rl,
+                             std::vector<PositionFloat> &unit_positions,
+                             bool first_render) {
+    if (first_render) {
+        unit_positions = random_positions(rl.number_of_nodes());
     }
-    return node_positions;
+    return draw_positions(rl,
+                          scale_positions(unit_positions, window_width,
+                                          window_height, rl.node_radius()),
+                          rl.node_radius());
 }
 
-// Render Force Directed Layout graph
-std::vector<Position> render(
-    ForceDirectedLayout &fd,
-    std::vector<std::pair<float, float> > &random_positions,
-    bool first_render) {
-    std::vector<Position> node_positions;
-    std::vector<PositionFloat> movement(fd.number_of_nodes(), {0.0, 0.0});
-    const int node_radius = fd.node_radius();
-    const int iterations = fd.iterations();
-    float temperature = 0.1;
-    // Change in temperature per iteration
-    float dt = temperature / (float)(iterations + 1);
-    // Optimal distance
-    float k = (float)(sqrt(1.0 / fd.number_of_nodes()));
+// Render Force Directed Layout graph, filling unit positions with the layout
+// updated from the previous one on the first render and reusing them
+// afterwards
+std::vector<Position> render(ForceDirectedLayout &fd,
+                             std::vector<PositionFloat> &unit_positions,
+                             bool first_render) {
     if (first_render) {
-        // Set random positions
-        for (int i = 0; i < fd.number_of_nodes(); i++) {
-            random_positions.push_back(std::make_pair(
-                (static_cast<float>(rand()) / static_cast<float>(RAND_MAX)),
-                (static_cast<float>(rand()) / static_cast<float>(RAND_MAX))));
-        }
-        for (int iter = 0; iter < iterations; iter++) {
-            for (int i = 0; i < fd.number_of_nodes(); i++) {
-                // Calculate repulsion
-                for (int j = (i + 1); j < fd.number_of_nodes(); j++) {
-                    float delta_x =
-                        random_positions[i].first - random_positions[j].first;
-                    float delta_y =
-                        random_positions[i].second - random_positions[j].second;
-                    float distance =
-                        sqrt((delta_x * delta_x) + (delta_y * delta_y));
-                    float repulsion = (k * k) / distance;
-                    // Update movement vector for node i
-                    movement[i].x += (delta_x / distance) * repulsion;
-                    movement[i].y += (delta_y / distance) * repulsion;
-                    // Update movemnt vector for node j
-                    movement[j].x -= (delta_x / distance) * repulsion;
-                    movement[j].y -= (delta_y / distance) * repulsion;
-                }
-                // Calculate attraction
-                for (int j = 0; j < fd.graph[i].size(); j++) {
-                    int neighbor_id = fd.graph[i][j].id;
-                    if (neighbor_id > i) {
-                        continue;
-                    }
-                    float delta_x = random_positions[i].first -
-                                    random_positions[neighbor_id].first;
-                    float delta_y = random_positions[i].second -
-                                    random_positions[neighbor_id].second;
-                    float distance =
-                        sqrt((delta_x * delta_x) + (delta_y * delta_y));
-                    float attraction = (distance * distance) / k;
-                    // Update movement vector for node i
-                    movement[i].x -= (delta_x / distance) * attraction;
-                    movement[i].y -= (delta_y / distance) * attraction;
-                    // Update movemnt vector for node j
-                    movement[neighbor_id].x +=
-                        (delta_x / distance) * attraction;
-                    movement[neighbor_id].y +=
-                        (delta_y / distance) * attraction;
-                }
-            }
-            for (int i = 0; i < fd.number_of_nodes(); i++) {
-                // Limit maximum movement to temperature
-                float movement_distance = sqrt((movement[i].x * movement[i].x) +
-                                               (movement[i].y * movement[i].y));
-                float capped_movement =
-                    std::min(movement_distance, temperature);
-                float capped_movement_x =
-                    (movement[i].x / movement_distance) * capped_movement;
-                float capped_movement_y =
-                    (movement[i].y / movement_distance) * capped_movement;
-                random_positions[i].first += capped_movement_x;
-                random_positions[i].second += capped_movement_y;
-            }
-            // Cool down temperature as a better configuration approaches
-            temperature -= dt;
-        }
-        float x_min = std::numeric_limits<float>::max();
-        float x_max = std::numeric_limits<float>::lowest();
-        float y_min = std::numeric_limits<float>::max();
-        float y_max = std::numeric_limits<float>::lowest();
-        for (int i = 0; i < random_positions.size(); i++) {
-            if (random_positions[i].first < x_min) {
-                x_min = random_positions[i].first;
-            }
-            if (random_positions[i].first > x_max) {
-                x_max = random_positions[i].first;
-            }
-            if (random_positions[i].second < y_min) {
-                y_min = random_positions[i].second;
-            }
-            if (random_positions[i].second > y_max) {
-                y_max = random_positions[i].second;
-            }
-        }
-        float width = x_max - x_min;
-        float height = y_max - y_min;
-        // Get scale factor
-        float x_scale = 1.0 / width;
-        float y_scale = 1.0 / height;
-        float scale = 0.9 * (x_scale < y_scale ? x_scale : y_scale);
-        float center_x = x_max + x_min;
-        float center_y = y_max + y_min;
-        float offset_x = (center_x / 2.0) * scale;
-        float offset_y = (center_y / 2.0) * scale;
-        for (int i = 0; i < random_positions.size(); i++) {
-            random_positions[i].first =
-                ((random_positions[i].first * scale) - offset_x) + 0.5;
-            random_positions[i].second =
-                ((random_positions[i].second * scale) - offset_y) + 0.5;
-        }
+        unit_positions = update_positions(fd);
     }
-    SDL_SetRenderDrawColor(renderer, node_color.red, node_color.green,
-                           node_color.blue, 0xFF);
-    for (int i = 0; i < fd.number_of_nodes(); i++) {
-        int node_x =
-            (int)((random_positions[i].first * (window_width - node_radius)) +
-                  node_radius);
-        int node_y =
-            (int)((random_positions[i].second * (window_height - node_radius)) +
-                  node_radius);
-        draw_circle(node_x, node_y, node_radius);
-        node_positions.push_back({node_x, node_y});
-    }
-    // Draw edges
-    SDL_SetRenderDrawColor(renderer, edge_color.red, edge_color.green,
-                           edge_color.blue, 0xFF);
-    for (int i = 0; i < fd.graph.size(); i++) {
-        for (int j = 0; j < fd.graph[i].size(); j++) {
-            // Draw edge (line) from node i to j
-            int node1_id = i;
-            int node2_id = (int)(fd.graph[i][j].id);
-            SDL_RenderDrawLine(renderer, node_positions[node1_id].x,
-                               node_positions[node1_id].y,
-                               node_positions[node2_id].x,
-                               node_positions[node2_id].y);
-        }
+    return draw_positions(fd,
+                          scale_positions(unit_positions, window_width,
+                                          window_height, fd.node_radius()),
+                          fd.node_radius());
+}
+
+// Render Multilevel Force Directed Layout graph, filling unit positions with
+// the layout updated from the previous one on the first render and reusing
+// them afterwards
+std::vector<Position> render(MultilevelForceDirectedLayout &ml,
+                             std::vector<PositionFloat> &unit_positions,
+                             bool first_render) {
+    if (first_render) {
+        unit_positions = update_positions(ml);
     }
-    return node_positions;
+    return draw_positions(ml,
+                          scale_positions(unit_positions, window_width,
+                                          window_height, ml.node_radius()),
+                          ml.node_radius());
 }
 
 namespace {
@@ -559,7 +546,7 @@ void draw_random(Graph &g, bool force_close = true) {
     bool redraw = true;
     SDL_Event event;
     // Cache random positions
-    std::vector<std::pair<float, float> > random_positions;
+    std::vector<PositionFloat> random_positions;
     bool first_render = true;
     while (!quit && SDL_WaitEvent(&event)) {
         if (event.type == SDL_QUIT) {
@@ -600,16 +587,16 @@ void animate_random(Graph &g, int width = window_width,
     bool quit = false;
     SDL_Event event;
     float delay = 1000.0 / fps;
-    int current_node = 0;
+    NodeId current_node = 0;
     bool reset = false;
     window_width = width;
     window_height = height;
     Graph animated_graph = g;
-    for (int i = 0; i < animated_graph.number_of_nodes(); i++) {
+    for (NodeId i = 0; i < animated_graph.number_of_nodes(); i++) {
         // Clear each node neighbor
         animated_graph.graph[i].clear();
     }
-    std::vector<std::pair<float, float> > random_positions;
+    std::vector<PositionFloat> random_positions;
     bool first_render = true;
     while (!quit) {
         while (SDL_PollEvent(&event)) {
@@ -622,7 +609,7 @@ void animate_random(Graph &g, int width = window_width,
             }
         }
         if (reset) {
-            for (int i = 0; i < animated_graph.number_of_nodes(); i++) {
+            for (NodeId i = 0; i < animated_graph.number_of_nodes(); i++) {
                 // Clear each node neighbor
                 animated_graph.graph[i].clear();
             }
@@ -694,6 +681,11 @@ inline void draw(ForceDirectedLayout &fd, bool force_close = true) {
     draw_random(fd);
 }
 
+// Draw multilevel force directed layout
+inline void draw(MultilevelForceDirectedLayout &ml, bool force_close = true) {
+    draw_random(ml, force_close);
+}
+
 // Animate a given graph
 template <typename Graph>
 void animate(Graph &g, int width = window_width, int height = window_height,
@@ -704,12 +696,12 @@ void animate(Graph &g, int width = window_width, int height = window_height,
     bool quit = false;
     SDL_Event event;
     float delay = 1000.0 / fps;
-    int current_node = 0;
+    NodeId current_node = 0;
     bool reset = false;
     window_width = width;
     window_height = height;
     Graph animated_graph = g;
-    for (int i = 0; i < animated_graph.number_of_nodes(); i++) {
+    for (NodeId i = 0; i < animated_graph.number_of_nodes(); i++) {
         // Clear each node neighbor
         animated_graph.graph[i].clear();
     }
@@ -724,7 +716,7 @@ void animate(Graph &g, int width = window_width, int height = window_height,
             }
         }
         if (reset) {
-            for (int i = 0; i < animated_graph.number_of_nodes(); i++) {
+            for (NodeId i = 0; i < animated_graph.number_of_nodes(); i++) {
                 // Clear each node neighbor
                 animated_graph.graph[i].clear();
             }
@@ -761,5 +753,12 @@ inline void animate(ForceDirectedLayout &fd, int width = window_width,
                     bool force_close = true) {
     animate_random(fd, width, height, fps, force_close);
 }
+
+// Animate multilevel force directed layout
+inline void animate(MultilevelForceDirectedLayout &ml, int width = window_width,
+                    int height = window_height, float fps = default_fps,
+                    bool force_close = true) {
+    animate_random(ml, width, height, fps, force_close);
+}
 }  // namespace graphw
 #endif
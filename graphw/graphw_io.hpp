@@ -0,0 +1,618 @@
+#ifndef GRAPHW_IO
+#define GRAPHW_IO
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_csr.hpp"
+
+namespace graphw {
+namespace detail {
+// Append the shortest representation of a number which round trips
+inline void append_number(std::string& buffer, double value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr - digits);
+}
+
+// Append text as a double quoted JSON string
+inline void append_json_string(std::string& buffer, std::string_view text) {
+    buffer += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            buffer += '\\';
+            buffer += c;
+        } else if ((unsigned char)(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            buffer += escaped;
+        } else {
+            buffer += c;
+        }
+    }
+    buffer += '"';
+}
+
+// Append text as a double quoted DOT identifier
+inline void append_dot_string(std::string& buffer, std::string_view text) {
+    buffer += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            buffer += '\\';
+        }
+        buffer += c;
+    }
+    buffer += '"';
+}
+
+// Append text with the characters which are special in XML escaped
+inline void append_xml_string(std::string& buffer, std::string_view text) {
+    for (char c : text) {
+        switch (c) {
+            case '&':
+                buffer += "&amp;";
+                break;
+            case '<':
+                buffer += "&lt;";
+                break;
+            case '>':
+                buffer += "&gt;";
+                break;
+            case '"':
+                buffer += "&quot;";
+                break;
+            case '\'':
+                buffer += "&apos;";
+                break;
+            default:
+                buffer += c;
+        }
+    }
+}
+
+// Call function(neighbor_id) for the entries of node i's neighbors which
+// represent distinct edges. An undirected edge is stored on both of its nodes
+// (a self loop twice on the same node) and only one entry is kept.
+template <typename Function>
+void for_each_edge(const Graph& g, size_t i, Function function) {
+    bool keep_loop = false;
+    for (auto const& neighbor : g.graph[i]) {
+        size_t j = (size_t)(neighbor.id);
+        if (!g.directed()) {
+            if (j < i) {
+                continue;
+            }
+            if (j == i) {
+                keep_loop = !keep_loop;
+                if (!keep_loop) {
+                    continue;
+                }
+            }
+        }
+        function(j);
+    }
+}
+
+// Return a sink which writes to a stream and throws if writing fails
+inline auto stream_sink(std::ostream& stream) {
+    return [&stream](const char* data, size_t size) {
+        if (!stream.write(data, (std::streamsize)(size))) {
+            throw GraphwError("Could not write graph");
+        }
+    };
+}
+
+// Return a sink which writes to a stream and drops the first character it is
+// given, used for lists where every item is formatted with a leading comma
+inline auto list_sink(std::ostream& stream) {
+    bool first = true;
+    return [&stream, first](const char* data, size_t size) mutable {
+        if (first && size > 0) {
+            data++;
+            size--;
+            first = false;
+        }
+        stream_sink(stream)(data, size);
+    };
+}
+
+// Check that positions are either empty or given for every node
+template <typename Position>
+void check_positions(const Graph& g, const std::vector<Position>& positions) {
+    if (!positions.empty() && positions.size() != g.graph.size()) {
+        throw GraphwError("Number of positions does not match number of nodes");
+    }
+}
+
+// Return the attribute columns with the given names
+inline std::vector<const std::vector<double>*> attribute_columns(
+    const Graph& g, const std::vector<std::string>& names) {
+    std::vector<const std::vector<double>*> columns;
+    for (auto const& name : names) {
+        columns.push_back(&g.attribute_column(name));
+    }
+    return columns;
+}
+}  // namespace detail
+
+// Write a graph in the Graphviz DOT format. Positions (as returned by render
+// or in any other units) are written as pinned pos attributes and attribute
+// columns as node attributes.
+template <typename Position = PositionFloat>
+void write_dot(const Graph& g, std::ostream& stream,
+               const std::vector<Position>& positions = {},
+               bool parallel = false) {
+    detail::check_positions(g, positions);
+    std::vector<std::string> names = g.attribute_names();
+    std::vector<const std::vector<double>*> columns =
+        detail::attribute_columns(g, names);
+    const char* edge_operator = g.directed() ? " -> " : " -- ";
+    stream << (g.directed() ? "digraph {\n" : "graph {\n");
+    detail::write_ranges(
+        g.graph.size(), [&names](size_t) { return names.size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                buffer += "  ";
+                detail::append_dot_string(buffer, g.label(i));
+                if (!positions.empty() || !names.empty()) {
+                    buffer += " [";
+                    if (!positions.empty()) {
+                        buffer += "pos=\"";
+                        detail::append_number(buffer, positions[i].x);
+                        buffer += ',';
+                        detail::append_number(buffer, positions[i].y);
+                        buffer += "!\"";
+                    }
+                    for (size_t k = 0; k < names.size(); k++) {
+                        if (k > 0 || !positions.empty()) {
+                            buffer += ", ";
+                        }
+                        detail::append_dot_string(buffer, names[k]);
+                        buffer += '=';
+                        detail::append_number(buffer, (*columns[k])[i]);
+                    }
+                    buffer += ']';
+                }
+                buffer += ";\n";
+            }
+        },
+        detail::stream_sink(stream), parallel);
+    detail::write_ranges(
+        g.graph.size(), [&g](size_t i) { return g.graph[i].size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                detail::for_each_edge(g, i, [&](size_t j) {
+                    buffer += "  ";
+                    detail::append_dot_string(buffer, g.label(i));
+                    buffer += edge_operator;
+                    detail::append_dot_string(buffer, g.label(j));
+                    buffer += ";\n";
+                });
+            }
+        },
+        detail::stream_sink(stream), parallel);
+    stream << "}\n";
+    if (!stream) {
+        throw GraphwError("Could not write graph");
+    }
+}
+
+// Write a graph in the GraphML format. Node ids are the node labels, and
+// positions and attribute columns are written as double valued data keys.
+template <typename Position = PositionFloat>
+void write_graphml(const Graph& g, std::ostream& stream,
+                   const std::vector<Position>& positions = {},
+                   bool parallel = false) {
+    detail::check_positions(g, positions);
+    std::vector<std::string> names = g.attribute_names();
+    std::vector<const std::vector<double>*> columns =
+        detail::attribute_columns(g, names);
+    std::string header =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n";
+    if (!positions.empty()) {
+        header +=
+            "  <key id=\"x\" for=\"node\" attr.name=\"x\" "
+            "attr.type=\"double\"/>\n"
+            "  <key id=\"y\" for=\"node\" attr.name=\"y\" "
+            "attr.type=\"double\"/>\n";
+    }
+    for (size_t k = 0; k < names.size(); k++) {
+        header += "  <key id=\"a" + std::to_string(k) +
+                  "\" for=\"node\" attr.name=\"";
+        detail::append_xml_string(header, names[k]);
+        header += "\" attr.type=\"double\"/>\n";
+    }
+    header += "  <graph id=\"G\" edgedefault=\"";
+    header += g.directed() ? "directed" : "undirected";
+    header += "\">\n";
+    stream << header;
+    detail::write_ranges(
+        g.graph.size(), [&names](size_t) { return names.size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                buffer += "    <node id=\"";
+                detail::append_xml_string(buffer, g.label(i));
+                if (positions.empty() && names.empty()) {
+                    buffer += "\"/>\n";
+                    continue;
+                }
+                buffer += "\">\n";
+                if (!positions.empty()) {
+                    buffer += "      <data key=\"x\">";
+                    detail::append_number(buffer, positions[i].x);
+                    buffer += "</data>\n      <data key=\"y\">";
+                    detail::append_number(buffer, positions[i].y);
+                    buffer += "</data>\n";
+                }
+                for (size_t k = 0; k < names.size(); k++) {
+                    buffer += "      <data key=\"a";
+                    buffer += std::to_string(k);
+                    buffer += "\">";
+                    detail::append_number(buffer, (*columns[k])[i]);
+                    buffer += "</data>\n";
+                }
+                buffer += "    </node>\n";
+            }
+        },
+        detail::stream_sink(stream), parallel);
+    detail::write_ranges(
+        g.graph.size(), [&g](size_t i) { return g.graph[i].size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                detail::for_each_edge(g, i, [&](size_t j) {
+                    buffer += "    <edge source=\"";
+                    detail::append_xml_string(buffer, g.label(i));
+                    buffer += "\" target=\"";
+                    detail::append_xml_string(buffer, g.label(j));
+                    buffer += "\"/>\n";
+                });
+            }
+        },
+        detail::stream_sink(stream), parallel);
+    stream << "  </graph>\n</graphml>\n";
+    if (!stream) {
+        throw GraphwError("Could not write graph");
+    }
+}
+
+// Write a graph in the GEXF 1.2 format. Node ids are node ids and labels are
+// written as node labels, positions are written as viz:position elements and
+// attribute columns as double valued node attributes.
+template <typename Position = PositionFloat>
+void write_gexf(const Graph& g, std::ostream& stream,
+                const std::vector<Position>& positions = {},
+                bool parallel = false) {
+    detail::check_positions(g, positions);
+    std::vector<std::string> names = g.attribute_names();
+    std::vector<const std::vector<double>*> columns =
+        detail::attribute_columns(g, names);
+    // Edges are given the index of their first neighbor entry as their id,
+    // which is unique without having to count edges in order
+    std::vector<size_t> first_entry(g.graph.size() + 1, 0);
+    for (size_t i = 0; i < g.graph.size(); i++) {
+        first_entry[i + 1] = first_entry[i] + g.graph[i].size();
+    }
+    std::string header =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<gexf xmlns=\"http://www.gexf.net/1.2draft\" "
+        "xmlns:viz=\"http://www.gexf.net/1.2draft/viz\" version=\"1.2\">\n"
+        "  <graph defaultedgetype=\"";
+    header += g.directed() ? "directed" : "undirected";
+    header += "\">\n";
+    if (!names.empty()) {
+        header += "    <attributes class=\"node\">\n";
+        for (size_t k = 0; k < names.size(); k++) {
+            header += "      <attribute id=\"" + std::to_string(k) +
+                      "\" title=\"";
+            detail::append_xml_string(header, names[k]);
+            header += "\" type=\"double\"/>\n";
+        }
+        header += "    </attributes>\n";
+    }
+    header += "    <nodes>\n";
+    stream << header;
+    detail::write_ranges(
+        g.graph.size(), [&names](size_t) { return names.size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                buffer += "      <node id=\"";
+                buffer += std::to_string(i);
+                buffer += "\" label=\"";
+                detail::append_xml_string(buffer, g.label(i));
+                if (positions.empty() && names.empty()) {
+                    buffer += "\"/>\n";
+                    continue;
+                }
+                buffer += "\">\n";
+                if (!names.empty()) {
+                    buffer += "        <attvalues>\n";
+                    for (size_t k = 0; k < names.size(); k++) {
+                        buffer += "          <attvalue for=\"";
+                        buffer += std::to_string(k);
+                        buffer += "\" value=\"";
+                        detail::append_number(buffer, (*columns[k])[i]);
+                        buffer += "\"/>\n";
+                    }
+                    buffer += "        </attvalues>\n";
+                }
+                if (!positions.empty()) {
+                    buffer += "        <viz:position x=\"";
+                    detail::append_number(buffer, positions[i].x);
+                    buffer += "\" y=\"";
+                    detail::append_number(buffer, positions[i].y);
+                    buffer += "\" z=\"0\"/>\n";
+                }
+                buffer += "      </node>\n";
+            }
+        },
+        detail::stream_sink(stream), parallel);
+    stream << "    </nodes>\n    <edges>\n";
+    detail::write_ranges(
+        g.graph.size(), [&g](size_t i) { return g.graph[i].size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                size_t entry = first_entry[i];
+                detail::for_each_edge(g, i, [&](size_t j) {
+                    buffer += "      <edge id=\"";
+                    buffer += std::to_string(entry++);
+                    buffer += "\" source=\"";
+                    buffer += std::to_string(i);
+                    buffer += "\" target=\"";
+                    buffer += std::to_string(j);
+                    buffer += "\"/>\n";
+                });
+            }
+        },
+        detail::stream_sink(stream), parallel);
+    stream << "    </edges>\n  </graph>\n</gexf>\n";
+    if (!stream) {
+        throw GraphwError("Could not write graph");
+    }
+}
+
+// Write a graph in the JSON node-link format read by tools such as networkx
+// and d3. Node ids are the node labels, and positions and attribute columns
+// are written as node properties.
+template <typename Position = PositionFloat>
+void write_json(const Graph& g, std::ostream& stream,
+                const std::vector<Position>& positions = {},
+                bool parallel = false) {
+    detail::check_positions(g, positions);
+    std::vector<std::string> names = g.attribute_names();
+    std::vector<const std::vector<double>*> columns =
+        detail::attribute_columns(g, names);
+    // JSON has no representation of infinite or NaN values
+    auto append_value = [](std::string& buffer, double value) {
+        if (std::isfinite(value)) {
+            detail::append_number(buffer, value);
+        } else {
+            buffer += "null";
+        }
+    };
+    stream << "{\"directed\": " << (g.directed() ? "true" : "false")
+           << ", \"multigraph\": false, \"graph\": {}, \"nodes\": [\n";
+    // Every item starts with a comma which the list sink drops for the first
+    detail::write_ranges(
+        g.graph.size(), [&names](size_t) { return names.size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                buffer += ",{\"id\": ";
+                detail::append_json_string(buffer, g.label(i));
+                if (!positions.empty()) {
+                    buffer += ", \"x\": ";
+                    append_value(buffer, positions[i].x);
+                    buffer += ", \"y\": ";
+                    append_value(buffer, positions[i].y);
+                }
+                for (size_t k = 0; k < names.size(); k++) {
+                    buffer += ", ";
+                    detail::append_json_string(buffer, names[k]);
+                    buffer += ": ";
+                    append_value(buffer, (*columns[k])[i]);
+                }
+                buffer += "}\n";
+            }
+        },
+        detail::list_sink(stream), parallel);
+    stream << "], \"links\": [\n";
+    detail::write_ranges(
+        g.graph.size(), [&g](size_t i) { return g.graph[i].size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            for (size_t i = begin; i < end; i++) {
+                detail::for_each_edge(g, i, [&](size_t j) {
+                    buffer += ",{\"source\": ";
+                    detail::append_json_string(buffer, g.label(i));
+                    buffer += ", \"target\": ";
+                    detail::append_json_string(buffer, g.label(j));
+                    buffer += "}\n";
+                });
+            }
+        },
+        detail::list_sink(stream), parallel);
+    stream << "]}\n";
+    if (!stream) {
+        throw GraphwError("Could not write graph");
+    }
+}
+
+// Read a graph from a file in the Matrix Market coordinate format. Entry (i,
+// j) becomes an edge from node i - 1 to node j - 1, and nodes are labelled by
+// their id. General matrices give directed graphs and symmetric ones
+// undirected graphs, values are ignored.
+inline CSRGraph read_matrix_market(const std::string& path) {
+    detail::MappedFile file(path);
+    std::string_view text(file.data(), file.size());
+    auto invalid = [&path](const std::string& reason) {
+        return GraphwError("Invalid Matrix Market file (" + reason +
+                           "): " + path);
+    };
+    // Read the banner, comments and size line
+    size_t position = 0;
+    auto next_line = [&text, &position]() {
+        size_t end = text.find('\n', position);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        std::string_view line = text.substr(position, end - position);
+        position = std::min(text.size(), end + 1);
+        return line;
+    };
+    std::string banner(next_line());
+    std::transform(banner.begin(), banner.end(), banner.begin(),
+                   [](char c) { return (char)(tolower(c)); });
+    if (banner.compare(0, 14, "%%matrixmarket") != 0) {
+        throw invalid("missing banner");
+    }
+    if (banner.find(" coordinate") == std::string::npos) {
+        throw invalid("only the coordinate format is supported");
+    }
+    bool directed = banner.find(" general") != std::string::npos;
+    std::string_view size_line;
+    do {
+        if (position >= text.size()) {
+            throw invalid("missing size line");
+        }
+        size_line = next_line();
+    } while (size_line.empty() || size_line[0] == '%');
+    uint64_t sizes[3];
+    const char* it = size_line.data();
+    const char* line_end = it + size_line.size();
+    for (int k = 0; k < 3; k++) {
+        while (it < line_end && detail::is_blank(*it)) {
+            it++;
+        }
+        auto result = std::from_chars(it, line_end, sizes[k]);
+        if (result.ec != std::errc()) {
+            throw invalid("bad size line");
+        }
+        it = result.ptr;
+    }
+    size_t nodes = std::max(sizes[0], sizes[1]);
+    if (nodes > (uint64_t)(std::numeric_limits<NodeId>::max())) {
+        throw invalid("too many nodes");
+    }
+    // Parse entries in parallel, converting to zero based ids
+    std::vector<NodeId> rows;
+    std::vector<NodeId> columns;
+    // Every entry takes at least four characters
+    size_t expected_entries = std::min<uint64_t>(sizes[2], file.size() / 4);
+    rows.reserve(expected_entries);
+    columns.reserve(expected_entries);
+    typedef std::vector<std::pair<NodeId, NodeId> > Entries;
+    detail::parse_lines<Entries>(
+        file.data() + position, file.size() - position,
+        [nodes](const char* it, const char* end, Entries& entries) {
+            while (it < end) {
+                const char* line_end =
+                    static_cast<const char*>(memchr(it, '\n', end - it));
+                if (line_end == nullptr) {
+                    line_end = end;
+                }
+                NodeId ids[2];
+                int count = 0;
+                while (count < 2) {
+                    while (it < line_end && detail::is_blank(*it)) {
+                        it++;
+                    }
+                    if (it == line_end || *it == '%') {
+                        break;
+                    }
+                    auto result = std::from_chars(it, line_end, ids[count]);
+                    if (result.ec != std::errc() || ids[count] < 1 ||
+                        (size_t)(ids[count]) > nodes) {
+                        throw GraphwError("Invalid Matrix Market entry");
+                    }
+                    it = result.ptr;
+                    count++;
+                }
+                if (count == 1) {
+                    throw GraphwError("Invalid Matrix Market entry");
+                } else if (count == 2) {
+                    entries.emplace_back(ids[0] - 1, ids[1] - 1);
+                }
+                it = line_end + 1;
+            }
+        },
+        [&rows, &columns](const Entries& entries) {
+            for (auto const& entry : entries) {
+                rows.push_back(entry.first);
+                columns.push_back(entry.second);
+            }
+        });
+    if (rows.size() != sizes[2]) {
+        throw invalid("expected " + std::to_string(sizes[2]) + " entries");
+    }
+    return CSRGraph::from_coo(nodes, rows.data(), columns.data(), rows.size(),
+                              directed);
+}
+
+// Write a graph in the Matrix Market coordinate pattern format. Directed
+// graphs are written as general matrices and undirected graphs as symmetric
+// matrices holding the lower triangle. Node ids are written one based.
+inline void write_matrix_market(const CSRGraph& g, std::ostream& stream,
+                                bool parallel = false) {
+    size_t nodes = g.number_of_nodes();
+    // Call function(j) for the entries of row i which are written
+    auto for_each_entry = [&g](size_t i, auto function) {
+        bool keep_loop = false;
+        for (NodeId neighbor_id : g.neighbors(i)) {
+            size_t j = (size_t)(neighbor_id);
+            if (!g.directed()) {
+                if (j > i) {
+                    continue;
+                }
+                if (j == i) {
+                    // Graphs built from Graph store self loops twice
+                    keep_loop = !keep_loop;
+                    if (!keep_loop) {
+                        continue;
+                    }
+                }
+            }
+            function(j);
+        }
+    };
+    size_t entries = 0;
+    for (size_t i = 0; i < nodes; i++) {
+        for_each_entry(i, [&entries](size_t) { entries++; });
+    }
+    stream << "%%MatrixMarket matrix coordinate pattern "
+           << (g.directed() ? "general" : "symmetric") << '\n'
+           << nodes << ' ' << nodes << ' ' << entries << '\n';
+    detail::write_ranges(
+        nodes, [&g](size_t i) { return g.neighbors(i).size(); },
+        [&](size_t begin, size_t end, std::string& buffer) {
+            char digits[24];
+            for (size_t i = begin; i < end; i++) {
+                for_each_entry(i, [&](size_t j) {
+                    auto result =
+                        std::to_chars(digits, digits + sizeof(digits), i + 1);
+                    buffer.append(digits, result.ptr - digits);
+                    buffer += ' ';
+                    result =
+                        std::to_chars(digits, digits + sizeof(digits), j + 1);
+                    buffer.append(digits, result.ptr - digits);
+                    buffer += '\n';
+                });
+            }
+        },
+        detail::stream_sink(stream), parallel);
+    if (!stream) {
+        throw GraphwError("Could not write graph");
+    }
+}
+}  // namespace graphw
+#endif
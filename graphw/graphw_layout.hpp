@@ -0,0 +1,1204 @@
+#ifndef GRAPHW_LAYOUT
+#define GRAPHW_LAYOUT
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_simd.hpp"
+
+namespace graphw {
+// Return the node radius of an arc diagram drawn in given width
+inline int arc_node_radius(const ArcDiagram &ad, int width) {
+    if (ad.number_of_nodes() == 0) {
+        return 0;
+    }
+    return (int)((width / (ad.number_of_nodes() * 2)) / 2);
+}
+
+// Return the node positions of an arc diagram drawn in a width x height area,
+// nodes are placed in order of id on a horizontal line through the center
+inline std::vector<PositionFloat> compute_layout(const ArcDiagram &ad,
+                                                 int width, int height) {
+    std::vector<PositionFloat> positions;
+    positions.reserve(ad.number_of_nodes());
+    int node_radius = arc_node_radius(ad, width);
+    int center_y = (int)(height / 2);
+    for (NodeId i = 0; i < ad.number_of_nodes(); i++) {
+        positions.push_back(
+            {(float)((node_radius * 2) + (i * (4 * node_radius))),
+             (float)(center_y)});
+    }
+    return positions;
+}
+
+namespace detail {
+// Return positions scaled by given factors and moved by given offsets. Each
+// coordinate is a multiply and an add, so resizing a cached layout is a
+// single pass without trigonometry which the compiler can vectorize.
+inline std::vector<PositionFloat> transform_positions(
+    const std::vector<PositionFloat> &positions, float scale_x, float scale_y,
+    float offset_x, float offset_y) {
+    std::vector<PositionFloat> transformed(positions.size());
+    const PositionFloat *source = positions.data();
+    PositionFloat *target = transformed.data();
+    for (size_t i = 0; i < positions.size(); i++) {
+        target[i].x = (source[i].x * scale_x) + offset_x;
+        target[i].y = (source[i].y * scale_y) + offset_y;
+    }
+    return transformed;
+}
+
+// Fill positions with the points at angle i * angle_step and distance
+// radius + (i * radius_step) from the origin. Points are generated with the
+// rotation kernels in chunks spread over threads, each chunk starting from
+// exact sines and cosines, so the error of the rotations stays far below
+// float precision.
+inline void rotation_positions(std::vector<PositionFloat> &positions,
+                               double angle_step, double radius,
+                               double radius_step) {
+    const size_t chunk_size = 1 << 16;
+    const size_t nodes = positions.size();
+    parallel_for((nodes + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+        rotation(positions.data(), chunk * chunk_size,
+                 std::min(nodes, (chunk + 1) * chunk_size), angle_step,
+                 radius, radius_step);
+    });
+}
+
+// Return the positions of n nodes placed in order of id on the unit circle
+inline std::vector<PositionFloat> circle_positions(NodeId n) {
+    std::vector<PositionFloat> positions(n);
+    if (n > 0) {
+        rotation_positions(positions, (2 * M_PI) / n, 1, 0);
+    }
+    return positions;
+}
+
+// Return circle positions scaled to a circular layout drawn in a
+// width x height area, around its center
+inline std::vector<PositionFloat> scale_circle(
+    const std::vector<PositionFloat> &positions, const CircularLayout &cl,
+    int width, int height) {
+    const int circle_padding = 5;
+    int center_x = (int)(width / 2);
+    int center_y = (int)(height / 2);
+    int circle_radius = (int)((std::min(width, height) / 2) - circle_padding -
+                              cl.node_radius());
+    return transform_positions(positions, circle_radius, circle_radius,
+                               center_x, center_y);
+}
+
+// Return the positions of the nodes of a spiral layout around the origin,
+// with one unit of distance between consecutive turns
+inline std::vector<PositionFloat> spiral_positions(const SpiralLayout &sl) {
+    const NodeId nodes = sl.number_of_nodes();
+    std::vector<PositionFloat> positions(nodes);
+    const float resolution = sl.resolution();
+    const float chord = 1;
+    const float step = sl.equidistant() ? 0.5 : 1.0;
+    if (!sl.equidistant()) {
+        // Node i is at angle i * resolution and distance i * step
+        rotation_positions(positions, resolution, 0, step);
+        return positions;
+    }
+    // Calculate node positions with equal distances. The angle of each node
+    // depends on the previous one, so the angles and distances are found in
+    // order first and turned into positions in parallel chunks afterwards.
+    float theta = resolution;
+    for (NodeId i = 0; i <= nodes; i++) {
+        float radius = step * theta;
+        theta += chord / radius;
+        if (i > 0) {
+            positions[i - 1] = {theta, radius};
+        }
+    }
+    // Each chunk starts from the exact sine and cosine of its first angle and
+    // rotates them by the difference to the next angle, from its Taylor
+    // series while the difference is small
+    const size_t chunk_size = 1 << 16;
+    parallel_for((nodes + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+        const size_t begin = chunk * chunk_size;
+        const size_t end = std::min<size_t>(nodes, begin + chunk_size);
+        double angle_cos = cos((double)positions[begin].x);
+        double angle_sin = sin((double)positions[begin].x);
+        for (size_t i = begin; i < end; i++) {
+            double angle = positions[i].x;
+            double radius = positions[i].y;
+            positions[i] = {(float)(angle_cos * radius),
+                            (float)(angle_sin * radius)};
+            if (i + 1 == end) {
+                break;
+            }
+            double next_angle = positions[i + 1].x;
+            double delta = next_angle - angle;
+            if (delta > 0.1) {
+                angle_cos = cos(next_angle);
+                angle_sin = sin(next_angle);
+                continue;
+            }
+            double delta_squared = delta * delta;
+            double delta_cos =
+                1 - (delta_squared * (0.5 - (delta_squared * (1.0 / 24))));
+            double delta_sin =
+                delta * (1 - (delta_squared * ((1.0 / 6) -
+                                               (delta_squared * (1.0 / 120)))));
+            double next_cos = (angle_cos * delta_cos) - (angle_sin * delta_sin);
+            angle_sin = (angle_sin * delta_cos) + (angle_cos * delta_sin);
+            angle_cos = next_cos;
+        }
+    });
+    return positions;
+}
+
+// Return spiral positions scaled to fit the smaller dimension of a spiral
+// layout drawn in a width x height area, starting at its center
+inline std::vector<PositionFloat> scale_spiral(
+    const std::vector<PositionFloat> &positions, const SpiralLayout &sl,
+    int width, int height) {
+    int center_x = (int)(width / 2);
+    int center_y = (int)(height / 2);
+    int min_dimension = std::min(width, height);
+    int padding = 4 * sl.node_radius();
+    // Get node max coordinate along the smaller window dimension
+    float max = 0;
+    for (const PositionFloat &position : positions) {
+        max = std::max(
+            std::fabs(width == min_dimension ? position.x : position.y), max);
+    }
+    // Adjust node positions with calculated factor
+    float factor = max > 0 ? ((float)(min_dimension - padding) / max) / 2 : 0;
+    return transform_positions(positions, factor, factor, center_x, center_y);
+}
+}  // namespace detail
+
+// Return the node positions of a circular layout drawn in a width x height
+// area, nodes are placed in order of id on a circle around the center
+inline std::vector<PositionFloat> compute_layout(const CircularLayout &cl,
+                                                 int width, int height) {
+    return detail::scale_circle(detail::circle_positions(cl.number_of_nodes()),
+                                cl, width, height);
+}
+
+// Return the node positions of a circular layout drawn in a width x height
+// area, computing the positions on the unit circle only when the version of
+// the graph changed since they were cached
+inline std::vector<PositionFloat> update_layout(CircularLayout &cl, int width,
+                                                int height) {
+    if (cl.positions_version() != cl.version()) {
+        cl.set_positions(detail::circle_positions(cl.number_of_nodes()),
+                         cl.version());
+    }
+    return detail::scale_circle(cl.positions(), cl, width, height);
+}
+
+// Return the node positions of a spiral layout drawn in a width x height area,
+// the spiral starts at the center and is scaled to fit the smaller dimension
+inline std::vector<PositionFloat> compute_layout(const SpiralLayout &sl,
+                                                 int width, int height) {
+    return detail::scale_spiral(detail::spiral_positions(sl), sl, width,
+                                height);
+}
+
+// Return the node positions of a spiral layout drawn in a width x height area,
+// computing the positions along the spiral only when the version of the graph
+// or the spiral changed since they were cached
+inline std::vector<PositionFloat> update_layout(SpiralLayout &sl, int width,
+                                                int height) {
+    if (sl.positions_version() != sl.version()) {
+        sl.set_positions(detail::spiral_positions(sl), sl.version());
+    }
+    return detail::scale_spiral(sl.positions(), sl, width, height);
+}
+
+namespace detail {
+// Quadtree over node positions used to approximate repulsion with the
+// Barnes-Hut method. Cells are kept in a flat pool which is reused every time
+// the tree is rebuilt, and the four children of a cell are stored next to each
+// other in the pool.
+class QuadTree {
+   public:
+    // Rebuild the tree over the positions of given number of nodes, stored
+    // as separate arrays of coordinates
+    void build(const float *x, const float *y, NodeId nodes) {
+        cells.clear();
+        if (nodes == 0) {
+            cells.push_back({0, 0, 0, 0, 0, 0, 0, -1});
+            return;
+        }
+        const auto x_range = std::minmax_element(x, x + nodes);
+        const auto y_range = std::minmax_element(y, y + nodes);
+        float x_min = *x_range.first;
+        float x_max = *x_range.second;
+        float y_min = *y_range.first;
+        float y_max = *y_range.second;
+        float half = std::max(x_max - x_min, y_max - y_min) / 2;
+        cells.push_back(
+            {(x_max + x_min) / 2, (y_max + y_min) / 2, half, 0, 0, 0, 0, -1});
+        for (NodeId i = 0; i < nodes; i++) {
+            insert(x, y, i);
+        }
+        // Turn sums of positions into centers of mass
+        for (Cell &cell : cells) {
+            if (cell.mass > 0) {
+                cell.x /= cell.mass;
+                cell.y /= cell.mass;
+            }
+        }
+    }
+
+    // Add the repulsion of every other node on the node at position (x, y) to
+    // force, where a node at distance d repels with strength / d. Cells whose
+    // width is below theta times their distance are treated as a single body.
+    void add_repulsion(float x, float y, float strength, float theta,
+                       float &force_x, float &force_y) const {
+        const float theta_squared = theta * theta;
+        // Cells left to visit, at most 3 siblings per level and 4 children
+        size_t stack[3 * max_depth + 4];
+        size_t stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size > 0) {
+            const Cell &cell = cells[stack[--stack_size]];
+            float delta_x = x - cell.x;
+            float delta_y = y - cell.y;
+            float distance_squared = (delta_x * delta_x) + (delta_y * delta_y);
+            if (cell.children != 0 &&
+                4 * cell.half * cell.half >= theta_squared * distance_squared) {
+                // Cell is too close to approximate, visit its children
+                for (size_t i = cell.children; i < cell.children + 4; i++) {
+                    if (cells[i].mass > 0) {
+                        stack[stack_size++] = i;
+                    }
+                }
+                continue;
+            }
+            if (distance_squared == 0) {
+                // Node itself or a node at the same position
+                continue;
+            }
+            float scale = (strength * cell.mass) / distance_squared;
+            force_x += delta_x * scale;
+            force_y += delta_y * scale;
+        }
+    }
+
+   private:
+    struct Cell {
+        float center_x;
+        float center_y;
+        float half;
+        // Number of nodes in the cell and their center of mass, which holds
+        // the sum of their positions while the tree is built
+        float mass;
+        float x;
+        float y;
+        // Index of the first child, 0 for leaves as the root is never a child
+        size_t children;
+        // Node in a leaf, -1 if there is none
+        NodeId body;
+    };
+
+    // Depth at which nodes at the same position stop splitting leaves
+    static const int max_depth = 24;
+
+    std::vector<Cell> cells;
+
+    // Return the index of the child of a cell which contains position (x, y)
+    inline size_t child(const Cell &cell, float x, float y) const {
+        return cell.children + (x >= cell.center_x) + 2 * (y >= cell.center_y);
+    }
+
+    // Add the node with given id to the tree
+    void insert(const float *x, const float *y, NodeId id) {
+        size_t index = 0;
+        for (int depth = 0;; depth++) {
+            Cell &cell = cells[index];
+            cell.mass += 1;
+            cell.x += x[id];
+            cell.y += y[id];
+            if (cell.children != 0) {
+                index = child(cell, x[id], y[id]);
+                continue;
+            }
+            if (cell.mass == 1) {
+                cell.body = id;
+                return;
+            }
+            if (depth == max_depth) {
+                // Leave nodes at the same position together in the leaf
+                return;
+            }
+            // Split the leaf and move its node to a child
+            NodeId body = cell.body;
+            float quarter = cell.half / 2;
+            float center_x = cell.center_x;
+            float center_y = cell.center_y;
+            cell.children = cells.size();
+            cell.body = -1;
+            for (int i = 0; i < 4; i++) {
+                cells.push_back({center_x + ((i & 1) ? quarter : -quarter),
+                                 center_y + ((i & 2) ? quarter : -quarter),
+                                 quarter, 0, 0, 0, 0, -1});
+            }
+            Cell &body_cell = cells[child(cells[index], x[body], y[body])];
+            body_cell.mass = 1;
+            body_cell.x = x[body];
+            body_cell.y = y[body];
+            body_cell.body = body;
+            index = child(cells[index], x[id], y[id]);
+        }
+    }
+};
+}  // namespace detail
+
+// Return n positions drawn uniformly from the unit square with rand
+inline std::vector<PositionFloat> random_positions(NodeId n) {
+    std::vector<PositionFloat> positions;
+    positions.reserve(n);
+    for (NodeId i = 0; i < n; i++) {
+        float x = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+        float y = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+        positions.push_back({x, y});
+    }
+    return positions;
+}
+
+// Return positions in the unit square scaled to a width x height area, leaving
+// a margin of node radius on the top and left
+inline std::vector<PositionFloat> scale_positions(
+    const std::vector<PositionFloat> &unit_positions, int width, int height,
+    int node_radius) {
+    return detail::transform_positions(unit_positions, width - node_radius,
+                                       height - node_radius, node_radius,
+                                       node_radius);
+}
+
+namespace detail {
+// Fill offsets and targets with the adjacency of a graph in CSR form, where
+// the neighbors of node i are targets[offsets[i]] to targets[offsets[i + 1]].
+// Edges of directed graphs are added in both directions, self loops are left
+// out.
+inline void symmetric_adjacency(const Graph &g, std::vector<size_t> &offsets,
+                                std::vector<NodeId> &targets) {
+    const NodeId nodes = g.number_of_nodes();
+    offsets.assign(nodes + 1, 0);
+    for (NodeId i = 0; i < nodes; i++) {
+        for (const Node &neighbor : g.graph[i]) {
+            if (neighbor.id != i) {
+                offsets[i + 1]++;
+                if (g.directed()) {
+                    offsets[neighbor.id + 1]++;
+                }
+            }
+        }
+    }
+    for (NodeId i = 0; i < nodes; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    targets.resize(offsets[nodes]);
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (NodeId i = 0; i < nodes; i++) {
+        for (const Node &neighbor : g.graph[i]) {
+            if (neighbor.id != i) {
+                targets[next[i]++] = neighbor.id;
+                if (g.directed()) {
+                    targets[next[neighbor.id]++] = i;
+                }
+            }
+        }
+    }
+}
+
+// Blocks threads of a group until all of them reach it, and can be reused.
+// Threads report whether they failed when they arrive, so that every thread
+// of the group learns of a failure at the same point and can stop together.
+class Barrier {
+   public:
+    explicit Barrier(size_t new_count) : count(new_count) {}
+
+    // Wait for every thread of the group to arrive and return whether any of
+    // them failed
+    bool wait(bool failed = false) {
+        std::unique_lock<std::mutex> lock(mutex);
+        any_failed = any_failed || failed;
+        size_t current_generation = generation;
+        if (++arrived == count) {
+            release();
+        } else {
+            all_arrived.wait(
+                lock, [&] { return generation != current_generation; });
+        }
+        return failed_generation;
+    }
+
+    // Remove a thread which will never arrive from the group
+    void leave() {
+        std::unique_lock<std::mutex> lock(mutex);
+        count--;
+        if (arrived > 0 && arrived == count) {
+            release();
+        }
+    }
+
+   private:
+    size_t count;
+    size_t arrived = 0;
+    size_t generation = 0;
+    bool any_failed = false;
+    // Whether a thread failed in the last generation, which stays valid
+    // until every thread has arrived again
+    bool failed_generation = false;
+    std::mutex mutex;
+    std::condition_variable all_arrived;
+
+    // Start the next generation and wake the waiting threads
+    void release() {
+        arrived = 0;
+        failed_generation = any_failed;
+        any_failed = false;
+        generation++;
+        all_arrived.notify_all();
+    }
+};
+
+// Return the number of threads to lay out given number of nodes with, where 0
+// requested threads means one per hardware thread. Every thread gets at least
+// 1024 nodes.
+inline size_t layout_threads(size_t requested, NodeId nodes) {
+    size_t threads = requested == 0 ? thread_count(SIZE_MAX) : requested;
+    return std::max<size_t>(1, std::min<size_t>(threads, nodes / 1024));
+}
+
+// Options of a run of force-directed iterations
+struct ForceOptions {
+    // Maximum number of iterations
+    int iterations = 300;
+    // Maximum movement of a node in the first iteration
+    float temperature = 0.1;
+    bool barnes_hut = false;
+    float theta = 0.9;
+    size_t threads = 1;
+    // Adapt the maximum movement to the progress of the energy instead of
+    // cooling it down linearly
+    bool adaptive_cooling = false;
+    // Iterations stop once no node would move more than tolerance times the
+    // optimal distance, which never happens for 0
+    float tolerance = 0;
+    // Iterations stop at the deadline, keeping the positions with the lowest
+    // energy found
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::time_point::max();
+    // Only nodes with a lower id move, the others are fixed
+    NodeId movable = std::numeric_limits<NodeId>::max();
+    // Optimal distance between nodes, 0 for that of the nodes laid out
+    float distance = 0;
+    SimdLevel simd = simd_level();
+};
+
+// Return the deadline of a layout with given time budget in milliseconds
+// starting now, which is never reached for a budget of 0
+inline std::chrono::steady_clock::time_point layout_deadline(int time_budget) {
+    if (time_budget <= 0) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return std::chrono::steady_clock::now() +
+           std::chrono::milliseconds(time_budget);
+}
+
+// Return the options of the iterations of a force directed layout
+inline ForceOptions force_options(const ForceDirectedLayout &fd) {
+    ForceOptions options;
+    options.iterations = fd.iterations();
+    options.barnes_hut = fd.barnes_hut();
+    options.theta = fd.theta();
+    options.threads = fd.threads();
+    options.adaptive_cooling = fd.adaptive_cooling();
+    options.tolerance = fd.tolerance();
+    options.deadline = layout_deadline(fd.time_budget());
+    return options;
+}
+
+// Run iterations of the Fruchterman-Reingold algorithm on positions of the
+// nodes of a graph in CSR form with symmetric adjacency and return the number
+// of iterations run. The optimal distance between nodes is that of n nodes in
+// the unit square unless given otherwise, and nodes from options.movable on
+// stay fixed. Positions are copied to separate arrays of coordinates while the
+// forces are computed with vectorized kernels.
+//
+// The maximum movement of a node either cools down linearly from the initial
+// temperature or follows the adaptive scheme of Hu, "Efficient and high
+// quality force-directed graph drawing": it grows after five iterations in a
+// row which lower the energy, the sum of the squared forces, and shrinks
+// after any iteration which does not.
+//
+// Nodes are split into one range per thread. In each iteration every thread
+// computes the forces on the nodes of its range, the first thread then
+// decides on the maximum movement and whether to stop, and every thread moves
+// the nodes of its range, so no two threads write the same memory. Without a
+// deadline the result only depends on the positions and the number of
+// threads. An exception thrown in any thread stops all of them at the next
+// barrier and is rethrown on the calling thread.
+inline int force_directed_steps(const std::vector<size_t> &offsets,
+                                const std::vector<NodeId> &targets,
+                                std::vector<PositionFloat> &positions,
+                                const ForceOptions &options) {
+    const NodeId nodes = positions.size();
+    const NodeId moving = std::min(nodes, options.movable);
+    if (moving == 0) {
+        return 0;
+    }
+    const size_t threads = layout_threads(options.threads, moving);
+    FloatArray x(nodes);
+    FloatArray y(nodes);
+    for (NodeId i = 0; i < nodes; i++) {
+        x[i] = positions[i].x;
+        y[i] = positions[i].y;
+    }
+    FloatArray movement_x(nodes, 0.0);
+    FloatArray movement_y(nodes, 0.0);
+    // Change in temperature per iteration of linear cooling
+    const float dt = options.temperature / (float)(options.iterations + 1);
+    // Optimal distance
+    const float k = options.distance > 0 ? options.distance
+                                         : (float)(sqrt(1.0 / nodes));
+    const bool has_deadline =
+        options.deadline != std::chrono::steady_clock::time_point::max();
+    ForceKernels kernels(offsets, targets, options.simd);
+    QuadTree tree;
+    Barrier barrier(threads);
+    // First exception thrown by any thread
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    // Run a phase of a thread, returning whether it threw
+    auto guard = [&](auto phase) {
+        try {
+            phase();
+            return false;
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            return true;
+        }
+    };
+    // Energy and largest force of the nodes of each thread
+    std::vector<double> energies(threads);
+    std::vector<float> max_forces(threads);
+    // State shared by the threads, which is only written by the first
+    float temperature = options.temperature;
+    float step = temperature;
+    double previous_energy = std::numeric_limits<double>::max();
+    int progress = 0;
+    bool stop = false;
+    bool timed_out = false;
+    int iterations_run = 0;
+    // Positions with the lowest energy found, kept when there is a deadline
+    FloatArray best_x;
+    FloatArray best_y;
+    double best_energy = std::numeric_limits<double>::max();
+    auto work = [&](size_t thread, bool failed) {
+        const NodeId begin = (NodeId)((moving * thread) / threads);
+        const NodeId end = (NodeId)((moving * (thread + 1)) / threads);
+        for (int iter = 0; iter < options.iterations; iter++) {
+            // Approximate repulsion with a quadtree of the current positions,
+            // which is built by the first thread
+            if (options.barnes_hut) {
+                if (thread == 0 && !failed) {
+                    failed = guard(
+                        [&] { tree.build(x.data(), y.data(), nodes); });
+                }
+                if (barrier.wait(failed)) {
+                    return;
+                }
+            }
+            failed = failed || guard([&] {
+                std::fill(movement_x.begin() + begin,
+                          movement_x.begin() + end, 0.0);
+                std::fill(movement_y.begin() + begin,
+                          movement_y.begin() + end, 0.0);
+                // Calculate repulsion
+                if (options.barnes_hut) {
+                    for (NodeId i = begin; i < end; i++) {
+                        tree.add_repulsion(x[i], y[i], k * k, options.theta,
+                                           movement_x[i], movement_y[i]);
+                    }
+                } else if (threads == 1 && moving == nodes) {
+                    kernels.repulsion(x.data(), y.data(), movement_x.data(),
+                                      movement_y.data(), nodes, k * k);
+                } else {
+                    kernels.repulsion(x.data(), y.data(), movement_x.data(),
+                                      movement_y.data(), nodes, k * k, begin,
+                                      end);
+                }
+                // Calculate attraction
+                kernels.attraction(x.data(), y.data(), movement_x.data(),
+                                   movement_y.data(), k, begin, end);
+                double energy = 0;
+                float max_force = 0;
+                for (NodeId i = begin; i < end; i++) {
+                    float force = (movement_x[i] * movement_x[i]) +
+                                  (movement_y[i] * movement_y[i]);
+                    energy += force;
+                    max_force = std::max(max_force, force);
+                }
+                energies[thread] = energy;
+                max_forces[thread] = sqrt(max_force);
+            });
+            if (barrier.wait(failed)) {
+                return;
+            }
+            if (thread == 0) {
+                failed = guard([&] {
+                    double energy = 0;
+                    float max_force = 0;
+                    for (size_t t = 0; t < threads; t++) {
+                        energy += energies[t];
+                        max_force = std::max(max_force, max_forces[t]);
+                    }
+                    if (has_deadline && energy < best_energy) {
+                        best_energy = energy;
+                        best_x = x;
+                        best_y = y;
+                    }
+                    // Stop once no node would move noticeably, or out of time
+                    if (std::min(max_force, temperature) <
+                        options.tolerance * k) {
+                        stop = true;
+                    } else if (has_deadline &&
+                               std::chrono::steady_clock::now() >=
+                                   options.deadline) {
+                        stop = true;
+                        timed_out = true;
+                    } else {
+                        iterations_run++;
+                    }
+                    step = temperature;
+                    // Cool down temperature as a better configuration
+                    // approaches
+                    if (!options.adaptive_cooling) {
+                        temperature -= dt;
+                    } else if (energy < previous_energy) {
+                        progress++;
+                        if (progress >= 5) {
+                            progress = 0;
+                            temperature = std::min(temperature / 0.9f,
+                                                   options.temperature);
+                        }
+                    } else {
+                        progress = 0;
+                        temperature *= 0.9f;
+                    }
+                    previous_energy = energy;
+                });
+            }
+            if (barrier.wait(failed) || stop) {
+                return;
+            }
+            // Limit maximum movement to temperature
+            failed = guard([&] {
+                kernels.move(x.data(), y.data(), movement_x.data(),
+                             movement_y.data(), step, begin, end);
+            });
+            if (barrier.wait(failed)) {
+                return;
+            }
+        }
+    };
+    // A thread which cannot be started leaves the group, and the calling
+    // thread reports the failure at the first barrier
+    std::vector<std::thread> workers;
+    bool spawn_failed = false;
+    for (size_t thread = 1; thread < threads; thread++) {
+        if (spawn_failed ||
+            guard([&] { workers.emplace_back(work, thread, false); })) {
+            spawn_failed = true;
+            barrier.leave();
+        }
+    }
+    work(0, spawn_failed);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (timed_out && !best_x.empty()) {
+        x.swap(best_x);
+        y.swap(best_y);
+    }
+    for (NodeId i = 0; i < nodes; i++) {
+        positions[i] = {x[i], y[i]};
+    }
+    return iterations_run;
+}
+
+// Scale positions to fit in the unit square with a margin of 5% on each side,
+// keeping their aspect ratio and centering them
+inline void fit_unit_square(std::vector<PositionFloat> &positions) {
+    float x_min = std::numeric_limits<float>::max();
+    float x_max = std::numeric_limits<float>::lowest();
+    float y_min = std::numeric_limits<float>::max();
+    float y_max = std::numeric_limits<float>::lowest();
+    for (const PositionFloat &position : positions) {
+        x_min = std::min(x_min, position.x);
+        x_max = std::max(x_max, position.x);
+        y_min = std::min(y_min, position.y);
+        y_max = std::max(y_max, position.y);
+    }
+    // Get scale factor from the larger side of the bounding box
+    float size = std::max(x_max - x_min, y_max - y_min);
+    float scale = size > 0 ? 0.9 / size : 0;
+    float offset_x = ((x_max + x_min) / 2.0) * scale;
+    float offset_y = ((y_max + y_min) / 2.0) * scale;
+    for (PositionFloat &position : positions) {
+        position.x = ((position.x * scale) - offset_x) + 0.5;
+        position.y = ((position.y * scale) - offset_y) + 0.5;
+    }
+}
+
+// Coarser version of a graph in which matched pairs of nodes are merged
+struct CoarseLevel {
+    // Adjacency of the coarse graph in CSR form
+    std::vector<size_t> offsets;
+    std::vector<NodeId> targets;
+    // Number of nodes of the original graph merged into each coarse node
+    std::vector<NodeId> mass;
+    // Coarse node of each node of the finer graph
+    std::vector<NodeId> parent;
+
+    // Return the number of coarse nodes
+    inline NodeId size() const { return (NodeId)(mass.size()); }
+};
+
+// Return the coarse level of a graph in CSR form with given node masses. Nodes
+// are visited in order of id and each node which is not matched yet is
+// matched with its unmatched neighbor of smallest mass, so that coarse nodes
+// stay balanced.
+inline CoarseLevel coarsen(const std::vector<size_t> &offsets,
+                           const std::vector<NodeId> &targets,
+                           const std::vector<NodeId> &mass) {
+    CoarseLevel level;
+    const NodeId nodes = mass.size();
+    level.parent.assign(nodes, -1);
+    for (NodeId i = 0; i < nodes; i++) {
+        if (level.parent[i] != -1) {
+            continue;
+        }
+        NodeId match = -1;
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            NodeId neighbor_id = targets[e];
+            if (level.parent[neighbor_id] == -1 && neighbor_id != i &&
+                (match == -1 || mass[neighbor_id] < mass[match])) {
+                match = neighbor_id;
+            }
+        }
+        level.parent[i] = level.size();
+        if (match != -1) {
+            level.parent[match] = level.size();
+        }
+        level.mass.push_back(0);
+    }
+    for (NodeId i = 0; i < nodes; i++) {
+        level.mass[level.parent[i]] += mass[i];
+    }
+    // Count and then place the edges of each coarse node, merging edges
+    // between the same coarse nodes afterwards
+    const NodeId coarse_nodes = level.size();
+    level.offsets.assign(coarse_nodes + 1, 0);
+    for (NodeId i = 0; i < nodes; i++) {
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            if (level.parent[targets[e]] != level.parent[i]) {
+                level.offsets[level.parent[i] + 1]++;
+            }
+        }
+    }
+    for (NodeId i = 0; i < coarse_nodes; i++) {
+        level.offsets[i + 1] += level.offsets[i];
+    }
+    level.targets.resize(level.offsets[coarse_nodes]);
+    std::vector<size_t> next(level.offsets.begin(), level.offsets.end() - 1);
+    for (NodeId i = 0; i < nodes; i++) {
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            NodeId coarse_neighbor = level.parent[targets[e]];
+            if (coarse_neighbor != level.parent[i]) {
+                level.targets[next[level.parent[i]]++] = coarse_neighbor;
+            }
+        }
+    }
+    size_t end = 0;
+    for (NodeId i = 0; i < coarse_nodes; i++) {
+        auto first = level.targets.begin() + level.offsets[i];
+        auto last = level.targets.begin() + level.offsets[i + 1];
+        std::sort(first, last);
+        last = std::unique(first, last);
+        level.offsets[i] = end;
+        end = std::copy(first, last, level.targets.begin() + end) -
+              level.targets.begin();
+    }
+    level.offsets[coarse_nodes] = end;
+    level.targets.resize(end);
+    return level;
+}
+
+// Place the nodes of a graph in CSR form from given id on, which were added
+// since positions were laid out, at the mean position of their placed
+// neighbors moved by a small random offset. Nodes are placed breadth first
+// from the new nodes next to placed ones, so each node and edge is handled
+// once, and nodes which are never reached get random positions.
+inline void seed_new_nodes(const std::vector<size_t> &offsets,
+                           const std::vector<NodeId> &targets,
+                           std::vector<PositionFloat> &positions,
+                           NodeId first_new) {
+    const NodeId nodes = offsets.size() - 1;
+    const float k = (float)(sqrt(1.0 / nodes));
+    positions.resize(nodes);
+    // New nodes are placed in the order they are queued
+    std::vector<bool> placed(nodes - first_new, false);
+    std::vector<bool> queued(nodes - first_new, false);
+    std::vector<NodeId> order;
+    for (NodeId i = first_new; i < nodes; i++) {
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            if (targets[e] < first_new) {
+                queued[i - first_new] = true;
+                order.push_back(i);
+                break;
+            }
+        }
+    }
+    for (size_t head = 0; head < order.size(); head++) {
+        NodeId i = order[head];
+        float x = 0;
+        float y = 0;
+        NodeId count = 0;
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            NodeId neighbor_id = targets[e];
+            if (neighbor_id < first_new || placed[neighbor_id - first_new]) {
+                x += positions[neighbor_id].x;
+                y += positions[neighbor_id].y;
+                count++;
+            } else if (!queued[neighbor_id - first_new]) {
+                queued[neighbor_id - first_new] = true;
+                order.push_back(neighbor_id);
+            }
+        }
+        // Every queued node has a placed neighbor, either an old node or the
+        // node which queued it
+        float jitter_x = static_cast<float>(rand()) / RAND_MAX - 0.5;
+        float jitter_y = static_cast<float>(rand()) / RAND_MAX - 0.5;
+        positions[i] = {(x / count) + (jitter_x * k),
+                        (y / count) + (jitter_y * k)};
+        placed[i - first_new] = true;
+    }
+    for (NodeId i = first_new; i < nodes; i++) {
+        if (!placed[i - first_new]) {
+            float x = static_cast<float>(rand()) / RAND_MAX;
+            float y = static_cast<float>(rand()) / RAND_MAX;
+            positions[i] = {x, y};
+        }
+    }
+}
+
+// Run force-directed iterations on the nodes of a graph in CSR form from
+// given id on and their neighborhood, keeping the rest of the layout fixed.
+// The region of nodes which move grows from the new nodes by breadth-first
+// search up to depth hops away and the nodes adjacent to it stay fixed around
+// it, where both are limited to max_region nodes. Forces are only computed
+// within the region and its border, so the work grows with the number of new
+// nodes rather than with the graph.
+inline void refine_new_nodes(const std::vector<size_t> &offsets,
+                             const std::vector<NodeId> &targets,
+                             std::vector<PositionFloat> &positions,
+                             NodeId first_new, ForceOptions options,
+                             int depth = 2, NodeId max_region = 0) {
+    const NodeId nodes = offsets.size() - 1;
+    if (first_new >= nodes) {
+        return;
+    }
+    if (max_region == 0) {
+        max_region = (16 * (nodes - first_new)) + 256;
+    }
+    // Local id of each node in the region or its border, in order of search
+    std::vector<NodeId> local(nodes, -1);
+    std::vector<NodeId> region;
+    for (NodeId i = first_new; i < nodes; i++) {
+        local[i] = region.size();
+        region.push_back(i);
+    }
+    size_t layer_begin = 0;
+    NodeId moving = 0;
+    NodeId limit = region.size() + max_region;
+    for (int hop = 0; hop <= depth; hop++) {
+        size_t layer_end = region.size();
+        if (hop == depth) {
+            // The last layer found is the fixed border of the region
+            moving = region.size();
+            limit = moving + max_region;
+        }
+        for (size_t r = layer_begin; r < layer_end; r++) {
+            NodeId i = region[r];
+            for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+                NodeId neighbor_id = targets[e];
+                if (local[neighbor_id] == -1 &&
+                    region.size() < (size_t)(limit)) {
+                    local[neighbor_id] = region.size();
+                    region.push_back(neighbor_id);
+                }
+            }
+        }
+        layer_begin = layer_end;
+    }
+    // Adjacency of the region and its border in local ids
+    std::vector<size_t> local_offsets(region.size() + 1, 0);
+    std::vector<NodeId> local_targets;
+    std::vector<PositionFloat> local_positions;
+    local_positions.reserve(region.size());
+    for (size_t r = 0; r < region.size(); r++) {
+        NodeId i = region[r];
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            if (local[targets[e]] != -1) {
+                local_targets.push_back(local[targets[e]]);
+            }
+        }
+        local_offsets[r + 1] = local_targets.size();
+        local_positions.push_back(positions[i]);
+    }
+    options.movable = moving;
+    options.distance = (float)(sqrt(1.0 / nodes));
+    options.temperature = std::min(options.temperature, 2 * options.distance);
+    force_directed_steps(local_offsets, local_targets, local_positions,
+                         options);
+    for (NodeId r = 0; r < moving; r++) {
+        positions[region[r]] = local_positions[r];
+    }
+}
+
+// Return whether every change to a graph since given version added one of
+// the nodes from first_new on or an adjacency list entry of one of them, in
+// which case the rest of the graph is unchanged. Each of these changes grows
+// the version of the graph by one.
+template <typename GraphType>
+inline bool only_appended(const GraphType &g, uint64_t version,
+                          NodeId first_new) {
+    const NodeId nodes = g.number_of_nodes();
+    if (version > g.version() || first_new > nodes) {
+        return false;
+    }
+    uint64_t appended = nodes - first_new;
+    for (NodeId i = 0; i < nodes; i++) {
+        if (i >= first_new) {
+            appended += g.graph[i].size();
+            continue;
+        }
+        for (const auto &neighbor : g.graph[i]) {
+            appended += neighbor.id >= first_new;
+        }
+    }
+    return g.version() - version == appended;
+}
+}  // namespace detail
+
+// Move positions in the unit square to a Fruchterman-Reingold layout of a
+// graph, running the iterations of the layout and then scaling the result to
+// fit in the unit square
+inline void apply_force_directed(const ForceDirectedLayout &fd,
+                                 std::vector<PositionFloat> &positions) {
+    std::vector<size_t> offsets;
+    std::vector<NodeId> targets;
+    detail::symmetric_adjacency(fd, offsets, targets);
+    detail::force_directed_steps(offsets, targets, positions,
+                                 detail::force_options(fd));
+    detail::fit_unit_square(positions);
+}
+
+// Move positions in the unit square to a multilevel force-directed layout of
+// a graph. The graph is coarsened by merging matched pairs of nodes until it
+// has at most coarsest_size() nodes or stops shrinking, the coarsest graph is
+// laid out starting from the mean positions of its merged nodes, and each
+// finer graph is then laid out starting from the positions of its coarse
+// nodes. The time budget covers all levels. The result is scaled to fit in
+// the unit square.
+inline void apply_force_directed(const MultilevelForceDirectedLayout &ml,
+                                 std::vector<PositionFloat> &positions) {
+    std::vector<size_t> offsets;
+    std::vector<NodeId> targets;
+    detail::symmetric_adjacency(ml, offsets, targets);
+    detail::ForceOptions options = detail::force_options(ml);
+    std::vector<detail::CoarseLevel> levels;
+    std::vector<NodeId> mass(ml.number_of_nodes(), 1);
+    // Sizes below one coarsen the graph until it stops shrinking
+    const NodeId coarsest_size = std::max(ml.coarsest_size(), (NodeId)(1));
+    while ((NodeId)(mass.size()) > coarsest_size) {
+        detail::CoarseLevel level =
+            levels.empty() ? detail::coarsen(offsets, targets, mass)
+                           : detail::coarsen(levels.back().offsets,
+                                             levels.back().targets, mass);
+        if (level.size() > 0.95 * mass.size()) {
+            // Few nodes could be matched, further levels would barely help
+            break;
+        }
+        mass = level.mass;
+        levels.push_back(std::move(level));
+    }
+    // Start each coarse node at the mean position of its merged nodes
+    std::vector<std::vector<PositionFloat> > level_positions(levels.size());
+    const std::vector<PositionFloat> *finer = &positions;
+    for (size_t l = 0; l < levels.size(); l++) {
+        const detail::CoarseLevel &level = levels[l];
+        level_positions[l].assign(level.size(), {0.0, 0.0});
+        // Number of finer nodes merged into each coarse node
+        std::vector<NodeId> members(level.size(), 0);
+        for (size_t i = 0; i < level.parent.size(); i++) {
+            level_positions[l][level.parent[i]].x += (*finer)[i].x;
+            level_positions[l][level.parent[i]].y += (*finer)[i].y;
+            members[level.parent[i]]++;
+        }
+        for (NodeId i = 0; i < level.size(); i++) {
+            level_positions[l][i].x /= members[i];
+            level_positions[l][i].y /= members[i];
+        }
+        finer = &level_positions[l];
+    }
+    for (size_t l = levels.size() + 1; l-- > 0;) {
+        // Level l is the original graph for 0 and levels[l - 1] otherwise
+        std::vector<PositionFloat> &current =
+            l == 0 ? positions : level_positions[l - 1];
+        const std::vector<size_t> &current_offsets =
+            l == 0 ? offsets : levels[l - 1].offsets;
+        const std::vector<NodeId> &current_targets =
+            l == 0 ? targets : levels[l - 1].targets;
+        options.temperature = 0.1;
+        options.iterations = ml.iterations();
+        if (l < levels.size()) {
+            // Start from the positions of the coarse nodes, moved apart by a
+            // small random offset
+            float k = (float)(sqrt(1.0 / current.size()));
+            for (size_t i = 0; i < current.size(); i++) {
+                const PositionFloat &coarse =
+                    level_positions[l][levels[l].parent[i]];
+                float jitter_x = static_cast<float>(rand()) / RAND_MAX - 0.5;
+                float jitter_y = static_cast<float>(rand()) / RAND_MAX - 0.5;
+                current[i] = {coarse.x + (jitter_x * k),
+                              coarse.y + (jitter_y * k)};
+            }
+            options.temperature = std::min(options.temperature, 2 * k);
+            options.iterations = ml.refinement_iterations();
+        }
+        // Finer levels only take the positions of their coarse nodes once
+        // the time budget is spent
+        if (std::chrono::steady_clock::now() < options.deadline) {
+            detail::force_directed_steps(current_offsets, current_targets,
+                                         current, options);
+        }
+        detail::fit_unit_square(current);
+    }
+}
+
+// Return the node positions of a random layout drawn in a width x height area
+inline std::vector<PositionFloat> compute_layout(const RandomLayout &rl,
+                                                 int width, int height) {
+    return scale_positions(random_positions(rl.number_of_nodes()), width,
+                           height, rl.node_radius());
+}
+
+// Return the node positions of a force directed layout drawn in a
+// width x height area, starting from random positions
+inline std::vector<PositionFloat> compute_layout(const ForceDirectedLayout &fd,
+                                                 int width, int height) {
+    std::vector<PositionFloat> positions =
+        random_positions(fd.number_of_nodes());
+    apply_force_directed(fd, positions);
+    return scale_positions(positions, width, height, fd.node_radius());
+}
+
+// Return the node positions of a multilevel force directed layout drawn in a
+// width x height area, starting from random positions
+inline std::vector<PositionFloat> compute_layout(
+    const MultilevelForceDirectedLayout &ml, int width, int height) {
+    std::vector<PositionFloat> positions =
+        random_positions(ml.number_of_nodes());
+    apply_force_directed(ml, positions);
+    return scale_positions(positions, width, height, ml.node_radius());
+}
+
+// Update the positions in the unit square of a force directed layout and
+// return them. The first update lays out the graph from random positions.
+// Later updates start from the positions of the previous one whenever the
+// version of the graph changed. If only nodes and their edges were added,
+// the new nodes are placed near their neighbors and only the layout around
+// them is refined, so the rest of the layout does not move. Any other change
+// refines the whole layout from its previous shape. Positions are laid out
+// from scratch again when nodes were removed or after set_positions({}).
+inline const std::vector<PositionFloat> &update_positions(
+    ForceDirectedLayout &fd) {
+    const NodeId nodes = fd.number_of_nodes();
+    std::vector<PositionFloat> positions = fd.positions();
+    const NodeId first_new = (NodeId)(positions.size());
+    if (first_new == 0 || first_new > nodes) {
+        positions = random_positions(nodes);
+        apply_force_directed(fd, positions);
+    } else if (fd.positions_version() != fd.version()) {
+        std::vector<size_t> offsets;
+        std::vector<NodeId> targets;
+        detail::symmetric_adjacency(fd, offsets, targets);
+        detail::seed_new_nodes(offsets, targets, positions, first_new);
+        detail::ForceOptions options = detail::force_options(fd);
+        // Positions set without a version only lack the new nodes
+        if (fd.positions_version() == UINT64_MAX ||
+            detail::only_appended(fd, fd.positions_version(), first_new)) {
+            detail::refine_new_nodes(offsets, targets, positions, first_new,
+                                     options);
+        } else {
+            options.temperature = std::min(
+                options.temperature, 2 * (float)(sqrt(1.0 / nodes)));
+            detail::force_directed_steps(offsets, targets, positions,
+                                         options);
+            detail::fit_unit_square(positions);
+        }
+    }
+    fd.set_positions(std::move(positions), fd.version());
+    return fd.positions();
+}
+
+// Update the positions in the unit square of a multilevel force directed
+// layout and return them, laying out the graph from scratch with the
+// multilevel algorithm and updating it like a force directed layout
+inline const std::vector<PositionFloat> &update_positions(
+    MultilevelForceDirectedLayout &ml) {
+    if (ml.positions().empty() ||
+        ml.positions().size() > (size_t)(ml.number_of_nodes())) {
+        std::vector<PositionFloat> positions =
+            random_positions(ml.number_of_nodes());
+        apply_force_directed(ml, positions);
+        ml.set_positions(std::move(positions), ml.version());
+    }
+    return update_positions(static_cast<ForceDirectedLayout &>(ml));
+}
+
+// Return the node positions of a force directed layout drawn in a
+// width x height area, updated from the positions of the previous update
+inline std::vector<PositionFloat> update_layout(ForceDirectedLayout &fd,
+                                                int width, int height) {
+    return scale_positions(update_positions(fd), width, height,
+                           fd.node_radius());
+}
+
+// Return the node positions of a multilevel force directed layout drawn in a
+// width x height area, updated from the positions of the previous update
+inline std::vector<PositionFloat> update_layout(
+    MultilevelForceDirectedLayout &ml, int width, int height) {
+    return scale_positions(update_positions(ml), width, height,
+                           ml.node_radius());
+}
+}  // namespace graphw
+#endif
@@ -0,0 +1,645 @@
+#ifndef GRAPHW_SIMD
+#define GRAPHW_SIMD
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <vector>
+
+#include "graphw.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRAPHW_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace graphw {
+namespace detail {
+// Allocator of memory aligned to a cache line, so that arrays can be loaded
+// into vector registers without crossing cache lines
+template <typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(
+            ::operator new(n * sizeof(T), std::align_val_t(64)));
+    }
+
+    void deallocate(T* pointer, size_t) {
+        ::operator delete(pointer, std::align_val_t(64));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const {
+        return false;
+    }
+};
+
+typedef std::vector<float, AlignedAllocator<float> > FloatArray;
+
+// Instruction sets the force-directed kernels can use
+enum class SimdLevel { scalar, sse, avx2 };
+
+// Return the best instruction set supported by the running CPU
+inline SimdLevel detect_simd_level() {
+#ifdef GRAPHW_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::sse;
+    }
+#endif
+    return SimdLevel::scalar;
+}
+
+// Return the best instruction set supported by the running CPU, which is
+// detected once
+inline SimdLevel simd_level() {
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+// Add the repulsion between nodes i and j, where a node at distance d repels
+// with strength / d, to the movement of both. Nodes at the same position do
+// not repel each other.
+inline void repel_pair(const float* x, const float* y, float* movement_x,
+                       float* movement_y, NodeId i, NodeId j, float strength) {
+    float delta_x = x[i] - x[j];
+    float delta_y = y[i] - y[j];
+    float distance_squared = (delta_x * delta_x) + (delta_y * delta_y);
+    if (distance_squared == 0) {
+        return;
+    }
+    float scale = strength / distance_squared;
+    movement_x[i] += delta_x * scale;
+    movement_y[i] += delta_y * scale;
+    movement_x[j] -= delta_x * scale;
+    movement_y[j] -= delta_y * scale;
+}
+
+// Add the repulsion between every pair of nodes to their movement
+inline void repulsion_scalar(const float* x, const float* y, float* movement_x,
+                             float* movement_y, NodeId nodes, float strength) {
+    for (NodeId i = 0; i < nodes; i++) {
+        for (NodeId j = i + 1; j < nodes; j++) {
+            repel_pair(x, y, movement_x, movement_y, i, j, strength);
+        }
+    }
+}
+
+// Add the repulsion of nodes first to last on node i to force, skipping
+// nodes at the same position as node i
+inline void repel_from(const float* x, const float* y, NodeId i, NodeId first,
+                       NodeId last, float strength, float& force_x,
+                       float& force_y) {
+    for (NodeId j = first; j < last; j++) {
+        float delta_x = x[i] - x[j];
+        float delta_y = y[i] - y[j];
+        float distance_squared = (delta_x * delta_x) + (delta_y * delta_y);
+        if (distance_squared != 0) {
+            float scale = strength / distance_squared;
+            force_x += delta_x * scale;
+            force_y += delta_y * scale;
+        }
+    }
+}
+
+// Add the repulsion of every node on nodes begin to end to their movement
+inline void repulsion_range_scalar(const float* x, const float* y,
+                                   float* movement_x, float* movement_y,
+                                   NodeId nodes, float strength, NodeId begin,
+                                   NodeId end) {
+    for (NodeId i = begin; i < end; i++) {
+        repel_from(x, y, i, 0, nodes, strength, movement_x[i], movement_y[i]);
+    }
+}
+
+// Add the attraction of every edge of nodes begin to end of a graph in CSR
+// form, where nodes at distance d attract with d * d / k, to the movement of
+// its first node
+inline void attraction_scalar(const float* x, const float* y,
+                              const std::vector<size_t>& offsets,
+                              const std::vector<NodeId>& targets,
+                              float* movement_x, float* movement_y, float k,
+                              NodeId begin, NodeId end) {
+    for (NodeId i = begin; i < end; i++) {
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            NodeId j = targets[e];
+            float delta_x = x[i] - x[j];
+            float delta_y = y[i] - y[j];
+            float distance = sqrt((delta_x * delta_x) + (delta_y * delta_y));
+            movement_x[i] -= (delta_x * distance) / k;
+            movement_y[i] -= (delta_y * distance) / k;
+        }
+    }
+}
+
+// Move every node by its movement, limited to a distance of temperature
+inline void move_scalar(float* x, float* y, const float* movement_x,
+                        const float* movement_y, NodeId nodes,
+                        float temperature) {
+    for (NodeId i = 0; i < nodes; i++) {
+        float distance = sqrt((movement_x[i] * movement_x[i]) +
+                              (movement_y[i] * movement_y[i]));
+        if (distance == 0) {
+            continue;
+        }
+        float scale = std::min(distance, temperature) / distance;
+        x[i] += movement_x[i] * scale;
+        y[i] += movement_y[i] * scale;
+    }
+}
+
+// Number of points rotated side by side by the rotation kernels
+const size_t rotation_lanes = 8;
+
+// Write the points at angle i * angle_step and distance
+// radius + (i * radius_step) from the origin to positions[i] for every i in
+// [begin, end). Sine and cosine are only computed for the first point of each
+// lane, the next points of a lane are found by rotating it by
+// rotation_lanes * angle_step in double precision.
+inline void rotation_scalar(PositionFloat* positions, size_t begin,
+                            size_t end, double angle_step, double radius,
+                            double radius_step) {
+    const double rotation_cos = cos(rotation_lanes * angle_step);
+    const double rotation_sin = sin(rotation_lanes * angle_step);
+    double lane_cos[rotation_lanes];
+    double lane_sin[rotation_lanes];
+    for (size_t l = 0; l < rotation_lanes; l++) {
+        lane_cos[l] = cos((double)(begin + l) * angle_step);
+        lane_sin[l] = sin((double)(begin + l) * angle_step);
+    }
+    for (size_t i = begin; i < end; i += rotation_lanes) {
+        for (size_t l = 0; l < rotation_lanes && i + l < end; l++) {
+            double distance = radius + ((double)(i + l) * radius_step);
+            positions[i + l] = {(float)(lane_cos[l] * distance),
+                                (float)(lane_sin[l] * distance)};
+            double next_cos =
+                (lane_cos[l] * rotation_cos) - (lane_sin[l] * rotation_sin);
+            lane_sin[l] =
+                (lane_sin[l] * rotation_cos) + (lane_cos[l] * rotation_sin);
+            lane_cos[l] = next_cos;
+        }
+    }
+}
+
+#ifdef GRAPHW_X86_SIMD
+// Return 1 / sqrt(value) from the hardware estimate refined by a Newton step,
+// 0 where value is 0
+__attribute__((target("sse2"))) inline __m128 inverse_sqrt_sse(
+    __m128 value) {
+    __m128 estimate = _mm_rsqrt_ps(value);
+    __m128 refined = _mm_mul_ps(
+        _mm_mul_ps(_mm_set1_ps(0.5f), estimate),
+        _mm_sub_ps(_mm_set1_ps(3.0f),
+                   _mm_mul_ps(_mm_mul_ps(value, estimate), estimate)));
+    return _mm_and_ps(refined, _mm_cmpneq_ps(value, _mm_setzero_ps()));
+}
+
+// Return the sum of the lanes of a vector
+__attribute__((target("sse2"))) inline float sum_sse(__m128 value) {
+    __m128 high = _mm_movehl_ps(value, value);
+    __m128 pairs = _mm_add_ps(value, high);
+    __m128 second = _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, second));
+}
+
+__attribute__((target("sse2"))) inline void repulsion_sse(
+    const float* x, const float* y, float* movement_x, float* movement_y,
+    NodeId nodes, float strength) {
+    const __m128 strength_vector = _mm_set1_ps(strength);
+    for (NodeId i = 0; i < nodes; i++) {
+        const __m128 x_i = _mm_set1_ps(x[i]);
+        const __m128 y_i = _mm_set1_ps(y[i]);
+        __m128 sum_x = _mm_setzero_ps();
+        __m128 sum_y = _mm_setzero_ps();
+        NodeId j = i + 1;
+        for (; j + 4 <= nodes; j += 4) {
+            __m128 delta_x = _mm_sub_ps(x_i, _mm_loadu_ps(x + j));
+            __m128 delta_y = _mm_sub_ps(y_i, _mm_loadu_ps(y + j));
+            __m128 distance_squared = _mm_add_ps(_mm_mul_ps(delta_x, delta_x),
+                                                 _mm_mul_ps(delta_y, delta_y));
+            __m128 inverse = inverse_sqrt_sse(distance_squared);
+            __m128 scale =
+                _mm_mul_ps(strength_vector, _mm_mul_ps(inverse, inverse));
+            __m128 force_x = _mm_mul_ps(delta_x, scale);
+            __m128 force_y = _mm_mul_ps(delta_y, scale);
+            sum_x = _mm_add_ps(sum_x, force_x);
+            sum_y = _mm_add_ps(sum_y, force_y);
+            _mm_storeu_ps(movement_x + j,
+                          _mm_sub_ps(_mm_loadu_ps(movement_x + j), force_x));
+            _mm_storeu_ps(movement_y + j,
+                          _mm_sub_ps(_mm_loadu_ps(movement_y + j), force_y));
+        }
+        movement_x[i] += sum_sse(sum_x);
+        movement_y[i] += sum_sse(sum_y);
+        for (; j < nodes; j++) {
+            repel_pair(x, y, movement_x, movement_y, i, j, strength);
+        }
+    }
+}
+
+__attribute__((target("sse2"))) inline void repulsion_range_sse(
+    const float* x, const float* y, float* movement_x, float* movement_y,
+    NodeId nodes, float strength, NodeId begin, NodeId end) {
+    const __m128 strength_vector = _mm_set1_ps(strength);
+    for (NodeId i = begin; i < end; i++) {
+        const __m128 x_i = _mm_set1_ps(x[i]);
+        const __m128 y_i = _mm_set1_ps(y[i]);
+        __m128 sum_x = _mm_setzero_ps();
+        __m128 sum_y = _mm_setzero_ps();
+        NodeId j = 0;
+        for (; j + 4 <= nodes; j += 4) {
+            __m128 delta_x = _mm_sub_ps(x_i, _mm_loadu_ps(x + j));
+            __m128 delta_y = _mm_sub_ps(y_i, _mm_loadu_ps(y + j));
+            __m128 distance_squared = _mm_add_ps(_mm_mul_ps(delta_x, delta_x),
+                                                 _mm_mul_ps(delta_y, delta_y));
+            __m128 inverse = inverse_sqrt_sse(distance_squared);
+            __m128 scale =
+                _mm_mul_ps(strength_vector, _mm_mul_ps(inverse, inverse));
+            sum_x = _mm_add_ps(sum_x, _mm_mul_ps(delta_x, scale));
+            sum_y = _mm_add_ps(sum_y, _mm_mul_ps(delta_y, scale));
+        }
+        movement_x[i] += sum_sse(sum_x);
+        movement_y[i] += sum_sse(sum_y);
+        repel_from(x, y, i, j, nodes, strength, movement_x[i], movement_y[i]);
+    }
+}
+
+__attribute__((target("sse2"))) inline void move_sse(
+    float* x, float* y, const float* movement_x, const float* movement_y,
+    NodeId nodes, float temperature) {
+    const __m128 temperature_vector = _mm_set1_ps(temperature);
+    NodeId i = 0;
+    for (; i + 4 <= nodes; i += 4) {
+        __m128 step_x = _mm_loadu_ps(movement_x + i);
+        __m128 step_y = _mm_loadu_ps(movement_y + i);
+        __m128 distance_squared = _mm_add_ps(_mm_mul_ps(step_x, step_x),
+                                             _mm_mul_ps(step_y, step_y));
+        __m128 inverse = inverse_sqrt_sse(distance_squared);
+        __m128 distance = _mm_mul_ps(distance_squared, inverse);
+        __m128 scale =
+            _mm_mul_ps(_mm_min_ps(distance, temperature_vector), inverse);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i),
+                                        _mm_mul_ps(step_x, scale)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i),
+                                        _mm_mul_ps(step_y, scale)));
+    }
+    move_scalar(x + i, y + i, movement_x + i, movement_y + i, nodes - i,
+                temperature);
+}
+
+__attribute__((target("avx2"))) inline __m256 inverse_sqrt_avx2(
+    __m256 value) {
+    __m256 estimate = _mm256_rsqrt_ps(value);
+    __m256 refined = _mm256_mul_ps(
+        _mm256_mul_ps(_mm256_set1_ps(0.5f), estimate),
+        _mm256_sub_ps(_mm256_set1_ps(3.0f),
+                      _mm256_mul_ps(_mm256_mul_ps(value, estimate), estimate)));
+    return _mm256_and_ps(
+        refined, _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_NEQ_OQ));
+}
+
+__attribute__((target("avx2"))) inline float sum_avx2(__m256 value) {
+    return sum_sse(_mm_add_ps(_mm256_castps256_ps128(value),
+                              _mm256_extractf128_ps(value, 1)));
+}
+
+__attribute__((target("avx2"))) inline void repulsion_avx2(
+    const float* x, const float* y, float* movement_x, float* movement_y,
+    NodeId nodes, float strength) {
+    const __m256 strength_vector = _mm256_set1_ps(strength);
+    for (NodeId i = 0; i < nodes; i++) {
+        const __m256 x_i = _mm256_set1_ps(x[i]);
+        const __m256 y_i = _mm256_set1_ps(y[i]);
+        __m256 sum_x = _mm256_setzero_ps();
+        __m256 sum_y = _mm256_setzero_ps();
+        NodeId j = i + 1;
+        for (; j + 8 <= nodes; j += 8) {
+            __m256 delta_x = _mm256_sub_ps(x_i, _mm256_loadu_ps(x + j));
+            __m256 delta_y = _mm256_sub_ps(y_i, _mm256_loadu_ps(y + j));
+            __m256 distance_squared =
+                _mm256_add_ps(_mm256_mul_ps(delta_x, delta_x),
+                              _mm256_mul_ps(delta_y, delta_y));
+            __m256 inverse = inverse_sqrt_avx2(distance_squared);
+            __m256 scale = _mm256_mul_ps(strength_vector,
+                                         _mm256_mul_ps(inverse, inverse));
+            __m256 force_x = _mm256_mul_ps(delta_x, scale);
+            __m256 force_y = _mm256_mul_ps(delta_y, scale);
+            sum_x = _mm256_add_ps(sum_x, force_x);
+            sum_y = _mm256_add_ps(sum_y, force_y);
+            _mm256_storeu_ps(movement_x + j,
+                             _mm256_sub_ps(_mm256_loadu_ps(movement_x + j),
+                                           force_x));
+            _mm256_storeu_ps(movement_y + j,
+                             _mm256_sub_ps(_mm256_loadu_ps(movement_y + j),
+                                           force_y));
+        }
+        movement_x[i] += sum_avx2(sum_x);
+        movement_y[i] += sum_avx2(sum_y);
+        for (; j < nodes; j++) {
+            repel_pair(x, y, movement_x, movement_y, i, j, strength);
+        }
+    }
+}
+
+__attribute__((target("avx2"))) inline void repulsion_range_avx2(
+    const float* x, const float* y, float* movement_x, float* movement_y,
+    NodeId nodes, float strength, NodeId begin, NodeId end) {
+    const __m256 strength_vector = _mm256_set1_ps(strength);
+    for (NodeId i = begin; i < end; i++) {
+        const __m256 x_i = _mm256_set1_ps(x[i]);
+        const __m256 y_i = _mm256_set1_ps(y[i]);
+        __m256 sum_x = _mm256_setzero_ps();
+        __m256 sum_y = _mm256_setzero_ps();
+        NodeId j = 0;
+        for (; j + 8 <= nodes; j += 8) {
+            __m256 delta_x = _mm256_sub_ps(x_i, _mm256_loadu_ps(x + j));
+            __m256 delta_y = _mm256_sub_ps(y_i, _mm256_loadu_ps(y + j));
+            __m256 distance_squared =
+                _mm256_add_ps(_mm256_mul_ps(delta_x, delta_x),
+                              _mm256_mul_ps(delta_y, delta_y));
+            __m256 inverse = inverse_sqrt_avx2(distance_squared);
+            __m256 scale = _mm256_mul_ps(strength_vector,
+                                         _mm256_mul_ps(inverse, inverse));
+            sum_x = _mm256_add_ps(sum_x, _mm256_mul_ps(delta_x, scale));
+            sum_y = _mm256_add_ps(sum_y, _mm256_mul_ps(delta_y, scale));
+        }
+        movement_x[i] += sum_avx2(sum_x);
+        movement_y[i] += sum_avx2(sum_y);
+        repel_from(x, y, i, j, nodes, strength, movement_x[i], movement_y[i]);
+    }
+}
+
+// Add the attraction of every edge of nodes begin to end to the movement of
+// its first node. Edges are processed in groups of 8 whatever their nodes,
+// and the forces of the edges of a node are then summed. Node ids must have
+// 32 bits.
+__attribute__((target("avx2"))) inline void attraction_avx2(
+    const float* x, const float* y, const std::vector<size_t>& offsets,
+    const std::vector<NodeId>& targets, const std::vector<NodeId>& sources,
+    float* force_x, float* force_y, float* movement_x, float* movement_y,
+    float k, NodeId begin, NodeId end) {
+    const size_t last = offsets[end];
+    const __m256 inverse_k = _mm256_set1_ps(1 / k);
+    size_t e = offsets[begin];
+    for (; e + 8 <= last; e += 8) {
+        __m256i source = _mm256_loadu_si256((const __m256i*)(&sources[e]));
+        __m256i target = _mm256_loadu_si256((const __m256i*)(&targets[e]));
+        __m256 delta_x = _mm256_sub_ps(_mm256_i32gather_ps(x, source, 4),
+                                       _mm256_i32gather_ps(x, target, 4));
+        __m256 delta_y = _mm256_sub_ps(_mm256_i32gather_ps(y, source, 4),
+                                       _mm256_i32gather_ps(y, target, 4));
+        __m256 distance_squared = _mm256_add_ps(
+            _mm256_mul_ps(delta_x, delta_x), _mm256_mul_ps(delta_y, delta_y));
+        __m256 distance = _mm256_mul_ps(distance_squared,
+                                        inverse_sqrt_avx2(distance_squared));
+        __m256 scale = _mm256_mul_ps(distance, inverse_k);
+        _mm256_storeu_ps(force_x + e, _mm256_mul_ps(delta_x, scale));
+        _mm256_storeu_ps(force_y + e, _mm256_mul_ps(delta_y, scale));
+    }
+    for (; e < last; e++) {
+        float delta_x = x[sources[e]] - x[targets[e]];
+        float delta_y = y[sources[e]] - y[targets[e]];
+        float distance = sqrt((delta_x * delta_x) + (delta_y * delta_y));
+        force_x[e] = (delta_x * distance) / k;
+        force_y[e] = (delta_y * distance) / k;
+    }
+    for (NodeId i = begin; i < end; i++) {
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            movement_x[i] -= force_x[e];
+            movement_y[i] -= force_y[e];
+        }
+    }
+}
+
+__attribute__((target("avx2"))) inline void move_avx2(
+    float* x, float* y, const float* movement_x, const float* movement_y,
+    NodeId nodes, float temperature) {
+    const __m256 temperature_vector = _mm256_set1_ps(temperature);
+    NodeId i = 0;
+    for (; i + 8 <= nodes; i += 8) {
+        __m256 step_x = _mm256_loadu_ps(movement_x + i);
+        __m256 step_y = _mm256_loadu_ps(movement_y + i);
+        __m256 distance_squared = _mm256_add_ps(
+            _mm256_mul_ps(step_x, step_x), _mm256_mul_ps(step_y, step_y));
+        __m256 inverse = inverse_sqrt_avx2(distance_squared);
+        __m256 distance = _mm256_mul_ps(distance_squared, inverse);
+        __m256 scale = _mm256_mul_ps(
+            _mm256_min_ps(distance, temperature_vector), inverse);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i),
+                                              _mm256_mul_ps(step_x, scale)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i),
+                                              _mm256_mul_ps(step_y, scale)));
+    }
+    move_scalar(x + i, y + i, movement_x + i, movement_y + i, nodes - i,
+                temperature);
+}
+
+// Interleave the coordinates of four points and store them to positions
+__attribute__((target("avx2"))) inline void store_points_avx2(
+    PositionFloat* positions, __m256d x, __m256d y) {
+    __m128 x_float = _mm256_cvtpd_ps(x);
+    __m128 y_float = _mm256_cvtpd_ps(y);
+    float* output = reinterpret_cast<float*>(positions);
+    _mm_storeu_ps(output, _mm_unpacklo_ps(x_float, y_float));
+    _mm_storeu_ps(output + 4, _mm_unpackhi_ps(x_float, y_float));
+}
+
+__attribute__((target("avx2"))) inline void rotation_avx2(
+    PositionFloat* positions, size_t begin, size_t end, double angle_step,
+    double radius, double radius_step) {
+    const __m256d rotation_cos =
+        _mm256_set1_pd(cos(rotation_lanes * angle_step));
+    const __m256d rotation_sin =
+        _mm256_set1_pd(sin(rotation_lanes * angle_step));
+    const __m256d distance_step =
+        _mm256_set1_pd(rotation_lanes * radius_step);
+    alignas(32) double lane_cos[rotation_lanes];
+    alignas(32) double lane_sin[rotation_lanes];
+    alignas(32) double lane_distance[rotation_lanes];
+    for (size_t l = 0; l < rotation_lanes; l++) {
+        lane_cos[l] = cos((double)(begin + l) * angle_step);
+        lane_sin[l] = sin((double)(begin + l) * angle_step);
+        lane_distance[l] = radius + ((double)(begin + l) * radius_step);
+    }
+    __m256d cos_low = _mm256_load_pd(lane_cos);
+    __m256d cos_high = _mm256_load_pd(lane_cos + 4);
+    __m256d sin_low = _mm256_load_pd(lane_sin);
+    __m256d sin_high = _mm256_load_pd(lane_sin + 4);
+    __m256d distance_low = _mm256_load_pd(lane_distance);
+    __m256d distance_high = _mm256_load_pd(lane_distance + 4);
+    size_t i = begin;
+    for (; i + rotation_lanes <= end; i += rotation_lanes) {
+        store_points_avx2(positions + i, _mm256_mul_pd(cos_low, distance_low),
+                          _mm256_mul_pd(sin_low, distance_low));
+        store_points_avx2(positions + i + 4,
+                          _mm256_mul_pd(cos_high, distance_high),
+                          _mm256_mul_pd(sin_high, distance_high));
+        __m256d next_cos = _mm256_sub_pd(_mm256_mul_pd(cos_low, rotation_cos),
+                                         _mm256_mul_pd(sin_low, rotation_sin));
+        sin_low = _mm256_add_pd(_mm256_mul_pd(sin_low, rotation_cos),
+                                _mm256_mul_pd(cos_low, rotation_sin));
+        cos_low = next_cos;
+        next_cos = _mm256_sub_pd(_mm256_mul_pd(cos_high, rotation_cos),
+                                 _mm256_mul_pd(sin_high, rotation_sin));
+        sin_high = _mm256_add_pd(_mm256_mul_pd(sin_high, rotation_cos),
+                                 _mm256_mul_pd(cos_high, rotation_sin));
+        cos_high = next_cos;
+        distance_low = _mm256_add_pd(distance_low, distance_step);
+        distance_high = _mm256_add_pd(distance_high, distance_step);
+    }
+    rotation_scalar(positions, i, end, angle_step, radius, radius_step);
+}
+#endif
+
+// Kernels of the force-directed layout of a graph in CSR form with symmetric
+// adjacency, on nodes stored as separate arrays of coordinates. The kernels
+// use the instruction set given at construction when the CPU supports it.
+// Kernels which take a range of nodes only write the movement or position of
+// those nodes, so they can run on disjoint ranges from multiple threads.
+class ForceKernels {
+   public:
+    ForceKernels(const std::vector<size_t>& new_offsets,
+                 const std::vector<NodeId>& new_targets,
+                 SimdLevel new_level = simd_level())
+        : offsets(new_offsets),
+          targets(new_targets),
+          level(std::min(new_level, simd_level())) {
+        if (gathers()) {
+            // Store the first node of every edge for gathers
+            sources.resize(targets.size());
+            for (size_t i = 0; i + 1 < offsets.size(); i++) {
+                std::fill(sources.begin() + offsets[i],
+                          sources.begin() + offsets[i + 1], (NodeId)(i));
+            }
+            force_x.resize(targets.size());
+            force_y.resize(targets.size());
+        }
+    }
+
+    // Return the instruction set the kernels use
+    inline SimdLevel simd() const { return level; }
+
+    // Add the repulsion between every pair of nodes, where a node at distance
+    // d repels with strength / d, to their movement. Each pair is visited
+    // once, so this is the fastest kernel on a single thread.
+    void repulsion(const float* x, const float* y, float* movement_x,
+                   float* movement_y, NodeId nodes, float strength) const {
+#ifdef GRAPHW_X86_SIMD
+        if (level == SimdLevel::avx2) {
+            return repulsion_avx2(x, y, movement_x, movement_y, nodes,
+                                  strength);
+        }
+        if (level == SimdLevel::sse) {
+            return repulsion_sse(x, y, movement_x, movement_y, nodes,
+                                 strength);
+        }
+#endif
+        repulsion_scalar(x, y, movement_x, movement_y, nodes, strength);
+    }
+
+    // Add the repulsion of every node on nodes begin to end to their movement
+    void repulsion(const float* x, const float* y, float* movement_x,
+                   float* movement_y, NodeId nodes, float strength,
+                   NodeId begin, NodeId end) const {
+#ifdef GRAPHW_X86_SIMD
+        if (level == SimdLevel::avx2) {
+            return repulsion_range_avx2(x, y, movement_x, movement_y, nodes,
+                                        strength, begin, end);
+        }
+        if (level == SimdLevel::sse) {
+            return repulsion_range_sse(x, y, movement_x, movement_y, nodes,
+                                       strength, begin, end);
+        }
+#endif
+        repulsion_range_scalar(x, y, movement_x, movement_y, nodes, strength,
+                               begin, end);
+    }
+
+    // Add the attraction of the edges of nodes begin to end, where nodes at
+    // distance d attract with d * d / k, to their movement
+    void attraction(const float* x, const float* y, float* movement_x,
+                    float* movement_y, float k, NodeId begin, NodeId end) {
+#ifdef GRAPHW_X86_SIMD
+        if (gathers()) {
+            return attraction_avx2(x, y, offsets, targets, sources,
+                                   force_x.data(), force_y.data(), movement_x,
+                                   movement_y, k, begin, end);
+        }
+#endif
+        attraction_scalar(x, y, offsets, targets, movement_x, movement_y, k,
+                          begin, end);
+    }
+
+    // Move nodes begin to end by their movement, limited to a distance of
+    // temperature
+    void move(float* x, float* y, const float* movement_x,
+              const float* movement_y, float temperature, NodeId begin,
+              NodeId end) const {
+        x += begin;
+        y += begin;
+        movement_x += begin;
+        movement_y += begin;
+        const NodeId nodes = end - begin;
+#ifdef GRAPHW_X86_SIMD
+        if (level == SimdLevel::avx2) {
+            return move_avx2(x, y, movement_x, movement_y, nodes,
+                             temperature);
+        }
+        if (level == SimdLevel::sse) {
+            return move_sse(x, y, movement_x, movement_y, nodes, temperature);
+        }
+#endif
+        move_scalar(x, y, movement_x, movement_y, nodes, temperature);
+    }
+
+   private:
+    // Return whether attraction gathers the positions of the nodes of edges,
+    // which needs AVX2 and 32-bit node ids
+    inline bool gathers() const {
+        return level == SimdLevel::avx2 && sizeof(NodeId) == 4;
+    }
+
+    const std::vector<size_t>& offsets;
+    const std::vector<NodeId>& targets;
+    SimdLevel level;
+    // First node of every edge and force along every edge, used by the
+    // vectorized attraction
+    std::vector<NodeId> sources;
+    FloatArray force_x;
+    FloatArray force_y;
+};
+
+// Write the points at angle i * angle_step and distance
+// radius + (i * radius_step) from the origin to positions[i] for every i in
+// [begin, end), with AVX2 instructions when the CPU supports them
+inline void rotation(PositionFloat* positions, size_t begin, size_t end,
+                     double angle_step, double radius, double radius_step,
+                     SimdLevel level = simd_level()) {
+#ifdef GRAPHW_X86_SIMD
+    if (level == SimdLevel::avx2 && simd_level() == SimdLevel::avx2) {
+        return rotation_avx2(positions, begin, end, angle_step, radius,
+                             radius_step);
+    }
+#endif
+    rotation_scalar(positions, begin, end, angle_step, radius, radius_step);
+}
+}  // namespace detail
+}  // namespace graphw
+#endif
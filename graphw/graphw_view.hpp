@@ -0,0 +1,345 @@
+#ifndef GRAPHW_VIEW
+#define GRAPHW_VIEW
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_csr.hpp"
+
+namespace graphw {
+class GraphView;
+
+// Iterates over the neighbor ids of a node in a GraphView, skipping neighbors
+// which are not in the view and edges rejected by its edge filter
+class ViewNeighborIterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = NodeId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const NodeId*;
+    using reference = NodeId;
+
+    ViewNeighborIterator(const GraphView* new_view, NodeId new_id,
+                         const Node* new_position, const Node* new_last)
+        : view(new_view), id(new_id), position(new_position), last(new_last) {
+        skip();
+    }
+
+    inline NodeId operator*() const { return position->id; }
+
+    inline ViewNeighborIterator& operator++() {
+        ++position;
+        skip();
+        return *this;
+    }
+
+    inline ViewNeighborIterator operator++(int) {
+        ViewNeighborIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    inline bool operator==(const ViewNeighborIterator& other) const {
+        return position == other.position;
+    }
+
+    inline bool operator!=(const ViewNeighborIterator& other) const {
+        return position != other.position;
+    }
+
+   private:
+    const GraphView* view;
+    NodeId id;
+    const Node* position;
+    const Node* last;
+
+    // Advance to the first neighbor from position which is in the view
+    inline void skip();
+};
+
+// Neighbor ids of a node in a GraphView, in the order of the graph
+struct ViewNeighborRange {
+    const GraphView* view;
+    NodeId id;
+    const Node* first;
+    const Node* last;
+
+    inline ViewNeighborIterator begin() const {
+        return ViewNeighborIterator(view, id, first, last);
+    }
+
+    inline ViewNeighborIterator end() const {
+        return ViewNeighborIterator(view, id, last, last);
+    }
+
+    // Return the number of neighbors, which are counted by visiting them
+    inline size_t size() const { return std::distance(begin(), end()); }
+};
+
+// Read-only view of part of a Graph which references the graph instead of
+// copying it. The view contains a set of nodes, stored as a bitmap over the
+// ids of the graph, and the edges between them which pass an optional edge
+// filter. Nodes keep their ids in the graph and edges are filtered while
+// iterating over neighbors. The graph must outlive the view and must not be
+// modified while the view is in use.
+class GraphView {
+   public:
+    using NodeFilter = std::function<bool(NodeId)>;
+    using EdgeFilter = std::function<bool(NodeId, NodeId)>;
+
+    // Construct a view of the whole graph
+    explicit GraphView(const Graph& g) : parent_(&g), all_nodes_(true) {}
+
+    // Construct a view of the nodes with given ids and the edges between them
+    GraphView(const Graph& g, std::vector<NodeId> node_ids)
+        : parent_(&g), all_nodes_(false), nodes_(std::move(node_ids)) {
+        std::sort(nodes_.begin(), nodes_.end());
+        nodes_.erase(std::unique(nodes_.begin(), nodes_.end()), nodes_.end());
+        if (!nodes_.empty() &&
+            (nodes_.front() < 0 || nodes_.back() >= g.number_of_nodes())) {
+            throw GraphwError(
+                "Node id out of range: " +
+                std::to_string(nodes_.front() < 0 ? nodes_.front()
+                                                  : nodes_.back()));
+        }
+        mask_.assign((g.graph.size() + 63) / 64, 0);
+        for (NodeId id : nodes_) {
+            mask_[id >> 6] |= (uint64_t)(1) << (id & 63);
+        }
+    }
+
+    // Construct a view of the nodes and edges accepted by given filters,
+    // either of which may be empty to accept everything. The node filter is
+    // called once per node of the graph, the edge filter every time an edge
+    // is visited. In an undirected graph the edge filter is called with the
+    // nodes of an edge in either order and should accept both or neither.
+    GraphView(const Graph& g, const NodeFilter& node_filter,
+              EdgeFilter edge_filter)
+        : parent_(&g),
+          all_nodes_(!node_filter),
+          edge_filter_(std::move(edge_filter)) {
+        if (node_filter) {
+            mask_.assign((g.graph.size() + 63) / 64, 0);
+            for (NodeId id = 0; id < g.number_of_nodes(); id++) {
+                if (node_filter(id)) {
+                    nodes_.push_back(id);
+                    mask_[id >> 6] |= (uint64_t)(1) << (id & 63);
+                }
+            }
+        }
+    }
+
+    // Return the graph the view references
+    inline const Graph& parent() const { return *parent_; }
+
+    // Return whether graph is directed
+    inline bool directed() const { return parent_->directed(); }
+
+    // Return number of nodes in the view
+    inline NodeId number_of_nodes() const {
+        return all_nodes_ ? parent_->number_of_nodes()
+                          : (NodeId)(nodes_.size());
+    }
+
+    // Return number of edges in the view, which are counted by visiting them
+    EdgeCount number_of_edges() const {
+        EdgeCount entries = 0;
+        for (NodeId i = 0; i < number_of_nodes(); i++) {
+            entries += (EdgeCount)(neighbors(node(i)).size());
+        }
+        // Undirected edges, including self loops, are stored on both nodes
+        return directed() ? entries : entries / 2;
+    }
+
+    // Return the id of the node at given index of the view, nodes are in
+    // increasing order of id
+    inline NodeId node(NodeId index) const {
+        return all_nodes_ ? index : nodes_[index];
+    }
+
+    // Return the index in the view of the node with given id, which must be
+    // in the view
+    inline NodeId index(NodeId id) const {
+        if (all_nodes_) {
+            return id;
+        }
+        return (NodeId)(std::lower_bound(nodes_.begin(), nodes_.end(), id) -
+                        nodes_.begin());
+    }
+
+    // Return whether the node with given id is in the view
+    inline bool contains(NodeId id) const {
+        if (id < 0 || id >= parent_->number_of_nodes()) {
+            return false;
+        }
+        return all_nodes_ || ((mask_[id >> 6] >> (id & 63)) & 1);
+    }
+
+    // Return whether the edge from node id1 to node id2 is in the view
+    inline bool contains_edge(NodeId id1, NodeId id2) const {
+        return contains(id1) && contains(id2) &&
+               (!edge_filter_ || edge_filter_(id1, id2));
+    }
+
+    // Return the neighbor ids of the node with given id, which are empty if
+    // the node is not in the view
+    inline ViewNeighborRange neighbors(NodeId id) const {
+        if (!contains(id)) {
+            return {this, id, nullptr, nullptr};
+        }
+        const std::vector<Node>& adjacency = parent_->graph[id];
+        return {this, id, adjacency.data(),
+                adjacency.data() + adjacency.size()};
+    }
+
+    // Return the label of the node with given id
+    inline const std::string& label(NodeId id) const {
+        return parent_->label(id);
+    }
+
+    // Return the id of the node with given label
+    NodeId id(const std::string& label) const {
+        NodeId node_id = parent_->id(label);
+        if (!contains(node_id)) {
+            throw GraphwError("Given label is not in the view");
+        }
+        return node_id;
+    }
+
+    // Return the degree of a node with given label
+    EdgeCount degree(const std::string& label) const {
+        return (EdgeCount)(neighbors(id(label)).size());
+    }
+
+    // Return a list of labels representing the neighbor of a given node label
+    std::list<std::string> get_neighbors(const std::string& label) const {
+        std::list<std::string> neighbors_list;
+        for (NodeId neighbor_id : neighbors(id(label))) {
+            neighbors_list.push_back(this->label(neighbor_id));
+        }
+        return neighbors_list;
+    }
+
+    // Return a CSR graph with the nodes and edges of the view, in which the
+    // node at index i of the view has id i. Labels and attributes are copied.
+    CSRGraph materialize() const {
+        auto arrays = std::make_shared<CSRGraph::Arrays>();
+        size_t nodes = number_of_nodes();
+        arrays->offsets.resize(nodes + 1);
+        arrays->label_offsets.resize(nodes + 1);
+        arrays->offsets[0] = 0;
+        arrays->label_offsets[0] = 0;
+        for (size_t i = 0; i < nodes; i++) {
+            NodeId node_id = node((NodeId)(i));
+            for (NodeId neighbor_id : neighbors(node_id)) {
+                arrays->targets.push_back(index(neighbor_id));
+            }
+            arrays->offsets[i + 1] = arrays->targets.size();
+            arrays->label_chars += label(node_id);
+            arrays->label_offsets[i + 1] = arrays->label_chars.size();
+        }
+        arrays->label_order.resize(nodes);
+        std::iota(arrays->label_order.begin(), arrays->label_order.end(), 0);
+        std::sort(arrays->label_order.begin(), arrays->label_order.end(),
+                  [this](NodeId id1, NodeId id2) {
+                      return label(node(id1)) < label(node(id2));
+                  });
+        for (auto const& column : parent_->attributes) {
+            arrays->attribute_names.push_back(column.first);
+            arrays->attribute_columns.push_back(select(column.second));
+        }
+        EdgeCount entries = (EdgeCount)(arrays->targets.size());
+        return CSRGraph(arrays, directed() ? entries : entries / 2,
+                        directed());
+    }
+
+    // Return a graph with the nodes and edges of the view, in which the node
+    // at index i of the view has id i. Layout can be any graph type, such as
+    // CircularLayout, so that the result can be passed to render and draw.
+    template <typename Layout = Graph>
+    Layout to_graph() const {
+        Layout layout(directed());
+        Graph& g = layout;
+        size_t nodes = number_of_nodes();
+        g.graph.resize(nodes);
+        g.labels_vector.reserve(nodes);
+        g.identities.reserve(nodes);
+        for (size_t i = 0; i < nodes; i++) {
+            g.labels_vector.push_back(label(node((NodeId)(i))));
+            g.identities.emplace(g.labels_vector.back(), (NodeId)(i));
+        }
+        EdgeCount entries = 0;
+        for (size_t i = 0; i < nodes; i++) {
+            for (NodeId neighbor_id : neighbors(node((NodeId)(i)))) {
+                NodeId neighbor_index = index(neighbor_id);
+                g.graph[i].push_back(
+                    {neighbor_index, g.labels_vector[neighbor_index]});
+                entries++;
+            }
+        }
+        for (auto const& column : parent_->attributes) {
+            g.attributes.emplace(column.first, select(column.second));
+        }
+        g.edges = directed() ? entries : entries / 2;
+        return layout;
+    }
+
+   private:
+    const Graph* parent_;
+    bool all_nodes_;
+    // Ids of the nodes in the view in increasing order and a bitmap with a
+    // bit set for each of them, both empty if all nodes are in the view
+    std::vector<NodeId> nodes_;
+    std::vector<uint64_t> mask_;
+    EdgeFilter edge_filter_;
+
+    // Return the values of a column indexed by node id at the nodes of the
+    // view
+    std::vector<double> select(const std::vector<double>& column) const {
+        if (all_nodes_) {
+            return column;
+        }
+        std::vector<double> values;
+        values.reserve(nodes_.size());
+        for (NodeId id : nodes_) {
+            values.push_back(column[id]);
+        }
+        return values;
+    }
+};
+
+inline void ViewNeighborIterator::skip() {
+    while (position != last && !view->contains_edge(id, position->id)) {
+        ++position;
+    }
+}
+
+// Return a view of the subgraph induced by the nodes with given ids
+inline GraphView subgraph(const Graph& g, std::vector<NodeId> node_ids) {
+    return GraphView(g, std::move(node_ids));
+}
+
+// Return a view of every node of a graph and the edges accepted by a filter
+inline GraphView edge_subgraph(const Graph& g,
+                               GraphView::EdgeFilter edge_filter) {
+    return GraphView(g, nullptr, std::move(edge_filter));
+}
+
+// Return a view of the nodes and edges of a graph accepted by given filters
+inline GraphView filtered(const Graph& g,
+                          const GraphView::NodeFilter& node_filter,
+                          GraphView::EdgeFilter edge_filter = nullptr) {
+    return GraphView(g, node_filter, std::move(edge_filter));
+}
+}  // namespace graphw
+#endif
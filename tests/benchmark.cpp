@@ -1,12 +1,21 @@
 #include <stdlib.h>
 
 #include <chrono>
+#include <cstdio>
 #include <exception>
+#include <fstream>
 #include <iostream>
 #include <list>
+#include <thread>
 #include <vector>
 
 #include "../graphw/graphw.hpp"
+#include "../graphw/graphw_compressed.hpp"
+#include "../graphw/graphw_concurrent.hpp"
+#include "../graphw/graphw_csr.hpp"
+#include "../graphw/graphw_io.hpp"
+#include "../graphw/graphw_layout.hpp"
+#include "../graphw/graphw_view.hpp"
 #include "../graphw/graphw_draw.hpp"
 
 std::vector<std::string> test_names;
@@ -240,5 +249,305 @@ int main() {
         graph.add_wheel(5000);
     }
 
+    test_case("write_adjacency_list");
+    {
+        graphw::Graph graph;
+        graph.add_circulant(20000, {1, 2, 3});
+        std::ofstream file("/dev/null");
+        Timer timer;
+        graph.write_adjacency_list(file, " ", true);
+    }
+
+    test_case("write_graphml");
+    {
+        graphw::Graph graph;
+        graph.add_circulant(20000, {1, 2, 3});
+        std::ofstream file("/dev/null");
+        Timer timer;
+        graphw::write_graphml(graph, file, {}, true);
+    }
+
+    test_case("load_edge_list");
+    {
+        const std::string path = "graphw_benchmark_edge_list.txt";
+        {
+            std::ofstream file(path);
+            for (int i = 1; i <= 100000; i++) {
+                file << (i / 2) << ' ' << i << '\n';
+            }
+        }
+        graphw::Graph graph;
+        {
+            Timer timer;
+            graph.load_edge_list(path);
+        }
+        std::remove(path.c_str());
+    }
+
+    test_case("load_adjacency_list");
+    {
+        const std::string path = "graphw_benchmark_adjacency_list.txt";
+        {
+            graphw::Graph source;
+            source.add_circular_ladder(20000);
+            std::ofstream file(path);
+            file << source.get_adjacency_list();
+        }
+        graphw::Graph graph;
+        {
+            Timer timer;
+            graph.load_adjacency_list(path);
+        }
+        std::remove(path.c_str());
+    }
+
+    test_case("write_snapshot");
+    {
+        const std::string path = "graphw_benchmark_snapshot.bin";
+        graphw::Graph graph;
+        graph.add_circulant(20000, {1, 2, 3});
+        graphw::CSRGraph csr(graph);
+        {
+            Timer timer;
+            csr.write_snapshot(path);
+        }
+
+        test_case("load_snapshot");
+        {
+            Timer timer;
+            graphw::CSRGraph loaded = graphw::CSRGraph::load_snapshot(path);
+        }
+        std::remove(path.c_str());
+    }
+
+    test_case("CompressedGraph [construct]");
+    {
+        graphw::Graph graph;
+        graph.add_circulant(20000, {1, 2, 3});
+        graphw::CSRGraph csr(graph);
+        graphw::CompressedGraph compressed;
+        {
+            Timer timer;
+            compressed = graphw::CompressedGraph(csr);
+        }
+
+        test_case("CompressedGraph [neighbors]");
+        {
+            Timer timer;
+            long long total = 0;
+            for (int i = 0; i < compressed.number_of_nodes(); i++) {
+                for (int neighbor_id : compressed.neighbors(i)) {
+                    total += neighbor_id;
+                }
+            }
+            if (total == 0) {
+                throw BenchmarkError("No neighbors");
+            }
+        }
+    }
+
+    test_case("reorder [gorder]");
+    {
+        graphw::Graph graph;
+        graph.add_circulant(20000, {1, 2, 3});
+        Timer timer;
+        graph.reorder(graphw::Ordering::gorder);
+    }
+
+    test_case("ConcurrentGraphBuilder");
+    {
+        graphw::ConcurrentGraphBuilder builder;
+        const int thread_count = 4;
+        Timer timer;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&builder, t]() {
+                for (int i = t + 1; i <= 100000; i += thread_count) {
+                    builder.add_edge(std::to_string(i / 2), std::to_string(i));
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        graphw::Graph graph = builder.build();
+    }
+
+    test_case("subgraph [to_graph]");
+    {
+        graphw::Graph graph;
+        graph.add_circulant(200000, {1, 2, 3});
+        Timer timer;
+        std::vector<graphw::NodeId> node_ids;
+        for (graphw::NodeId i = 0; i < 1000; i++) {
+            node_ids.push_back(i * 150);
+            node_ids.push_back(i * 150 + 1);
+        }
+        graphw::CircularLayout layout = graphw::subgraph(graph, node_ids)
+                                            .to_graph<graphw::CircularLayout>();
+        if (layout.number_of_edges() != 1000) {
+            throw BenchmarkError("Wrong number of edges");
+        }
+    }
+
+    test_case("add_edge [id]");
+    {
+        graphw::Graph graph;
+        graph.add_empty(100000);
+        Timer timer;
+        for (graphw::NodeId i = 0; i < 100000; i++) {
+            for (graphw::NodeId offset = 1; offset <= 5; offset++) {
+                graph.add_edge(i, (i + offset) % 100000);
+            }
+        }
+    }
+
+    test_case("add_edge [id, integer labels]");
+    {
+        graphw::BasicGraph<graphw::Undirected, graphw::IntegerLabels> graph;
+        Timer timer;
+        for (graphw::NodeId i = 0; i < 100000; i++) {
+            for (graphw::NodeId offset = 1; offset <= 5; offset++) {
+                graph.add_edge(i, (i + offset) % 100000);
+            }
+        }
+    }
+
+    test_case("add_complete [dense]");
+    {
+        graphw::Graph graph;
+        graph.set_dense_threshold(0.05);
+        Timer timer;
+        graph.add_complete(1000);
+    }
+
+    test_case("add_complete [sparse]");
+    {
+        graphw::Graph graph;
+        Timer timer;
+        graph.add_complete(1000);
+    }
+
+    test_case("compute_layout [force directed]");
+    {
+        graphw::ForceDirectedLayout layout(false, 20, 50);
+        layout.add_circular_ladder(500);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [force directed, barnes-hut]");
+    {
+        graphw::ForceDirectedLayout layout(false, 20, 50, true);
+        layout.add_circular_ladder(500);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [force directed, barnes-hut, 20000 nodes]");
+    {
+        graphw::ForceDirectedLayout layout(false, 20, 20, true);
+        layout.add_circular_ladder(10000);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [force directed, barnes-hut, 20000 nodes, 1 "
+              "thread]");
+    {
+        graphw::ForceDirectedLayout layout(false, 20, 20, true);
+        layout.set_threads(1);
+        layout.add_circular_ladder(10000);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [multilevel, 20000 nodes]");
+    {
+        graphw::MultilevelForceDirectedLayout layout;
+        layout.add_circular_ladder(10000);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [force directed, adaptive cooling]");
+    {
+        graphw::ForceDirectedLayout layout;
+        layout.add_circular_ladder(500);
+        layout.set_adaptive_cooling(true);
+        layout.set_tolerance(0.01);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [force directed, 200 ms budget]");
+    {
+        graphw::ForceDirectedLayout layout;
+        layout.add_circular_ladder(10000);
+        layout.set_barnes_hut(true);
+        layout.set_time_budget(200);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("update_layout [50 nodes added to 50000]");
+    {
+        graphw::ForceDirectedLayout layout;
+        layout.add_circular_ladder(25000);
+        layout.set_positions(
+            graphw::random_positions(layout.number_of_nodes()));
+        for (graphw::NodeId i = 0; i < 50; i++) {
+            layout.add_edge(layout.add_node().id, i * 1000);
+        }
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::update_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [spiral]");
+    {
+        graphw::SpiralLayout layout;
+        layout.add_empty(1000000);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [spiral, equidistant]");
+    {
+        graphw::SpiralLayout layout;
+        layout.add_empty(1000000);
+        layout.set_equidistant(true);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("compute_layout [circular]");
+    {
+        graphw::CircularLayout layout;
+        layout.add_empty(1000000);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(layout, 640, 480);
+    }
+
+    test_case("update_layout [spiral, resize]");
+    {
+        graphw::SpiralLayout layout;
+        layout.add_empty(1000000);
+        graphw::update_layout(layout, 640, 480);
+        Timer timer;
+        std::vector<graphw::PositionFloat> positions =
+            graphw::update_layout(layout, 1280, 720);
+    }
+
     print_results();
 }
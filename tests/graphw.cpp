@@ -1,6 +1,13 @@
 #include "graphw.hpp"
 
+#include <algorithm>
 #include <catch2/catch.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <vector>
 
 TEST_CASE("Initial construction") {
     // Graphw should be empty on construction
@@ -235,7 +242,7 @@ TEST_CASE("Add complete multipartite") {
     graphw::Graph graph;
     int expected_nodes = 6;
     int expected_edges = 11;
-    std::list<int> subset_sizes{1, 2, 3};
+    std::list<graphw::NodeId> subset_sizes{1, 2, 3};
     graph.add_complete_multipartite(subset_sizes);
 
     int nodes = graph.number_of_nodes();
@@ -277,7 +284,7 @@ TEST_CASE("Add circulant") {
     int expected_nodes = 2;
     int expected_edges = 4;
     int n = 2;
-    std::list<int> offsets{1, 2};
+    std::list<graphw::NodeId> offsets{1, 2};
     graph.add_circulant(n, offsets);
 
     int nodes = graph.number_of_nodes();
@@ -467,3 +474,370 @@ TEST_CASE("Add whell with n < 0") {
     graphw::Graph graph;
     REQUIRE_THROWS(graph.add_wheel(-1));
 }
+
+TEST_CASE("Load edge list") {
+    const std::string path = "graphw_test_edge_list.txt";
+    {
+        std::ofstream file(path);
+        file << "# comment\na b\nb\tc 1.5\n\nd\nc a\n";
+    }
+    graphw::Graph graph;
+    graph.load_edge_list(path);
+    std::remove(path.c_str());
+
+    int nodes = graph.number_of_nodes();
+    int edges = graph.number_of_edges();
+    CHECK(nodes == 4);
+    CHECK(edges == 3);
+    CHECK(graph.degree("a") == 2);
+    CHECK(graph.degree("d") == 0);
+}
+
+TEST_CASE("Load edge list with missing file") {
+    graphw::Graph graph;
+    REQUIRE_THROWS(graph.load_edge_list("graphw_test_missing.txt"));
+}
+
+TEST_CASE("Load adjacency list round trip") {
+    const std::string path = "graphw_test_adjacency_list.txt";
+    graphw::Graph graph;
+    graph.add_ladder(3);
+    graph.add_edge("x", "0");
+    graph.add_edge("x", "x");
+    std::string expected = graph.get_adjacency_list(", ");
+    {
+        std::ofstream file(path);
+        file << expected;
+    }
+    graphw::Graph loaded;
+    loaded.load_adjacency_list(path, ", ");
+    std::remove(path.c_str());
+
+    CHECK(loaded.get_adjacency_list(", ") == expected);
+    CHECK(loaded.number_of_nodes() == graph.number_of_nodes());
+    CHECK(loaded.number_of_edges() == graph.number_of_edges());
+}
+
+TEST_CASE("Write adjacency list to stream") {
+    graphw::Graph graph;
+    graph.add_balanced_tree(3, 4);
+    std::string expected = graph.get_adjacency_list();
+
+    std::ostringstream stream;
+    graph.write_adjacency_list(stream);
+    CHECK(stream.str() == expected);
+
+    std::ostringstream parallel_stream;
+    graph.write_adjacency_list(parallel_stream, " ", true);
+    CHECK(parallel_stream.str() == expected);
+}
+
+TEST_CASE("Write adjacency list to file descriptor") {
+    const std::string path = "graphw_test_write_adjacency_list.txt";
+    graphw::Graph graph;
+    graph.add_circulant(50, {1, 7});
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    graph.write_adjacency_list(fd, ",", true);
+    close(fd);
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::remove(path.c_str());
+    CHECK(contents.str() == graph.get_adjacency_list(","));
+}
+
+TEST_CASE("Set attribute") {
+    graphw::Graph graph;
+    graph.add_edge("a", "b");
+    graph.set_attribute("weight", "b", 1.5);
+    graph.add_node("c");
+
+    CHECK(graph.attribute("weight", "a") == 0.0);
+    CHECK(graph.attribute("weight", "b") == 1.5);
+    CHECK(graph.attribute("weight", "c") == 0.0);
+    CHECK(graph.attribute_column("weight").size() == 3);
+    REQUIRE_THROWS(graph.set_attribute("weight", "d", 1.0));
+    REQUIRE_THROWS(graph.attribute("size", "a"));
+}
+
+TEST_CASE("Reorder nodes") {
+    for (graphw::Ordering ordering :
+         {graphw::Ordering::reverse_cuthill_mckee, graphw::Ordering::degree,
+          graphw::Ordering::hub_cluster, graphw::Ordering::gorder}) {
+        graphw::Graph graph;
+        graph.add_lollipop(5, 8);
+        graph.add_edge("x", "3");
+        graph.set_attribute("weight", "7", 2.0);
+        graphw::Graph original = graph;
+        std::vector<graphw::NodeId> order = graph.reorder(ordering);
+
+        std::vector<graphw::NodeId> sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        for (int i = 0; i < graph.number_of_nodes(); i++) {
+            CHECK(sorted[i] == i);
+            CHECK(graph.label(i) == original.label(order[i]));
+            CHECK(graph.degree(graph.label(i)) ==
+                  original.degree(graph.label(i)));
+        }
+        CHECK(graph.number_of_edges() == original.number_of_edges());
+        CHECK(graph.get_neighbors("3") == original.get_neighbors("3"));
+        CHECK(graph.attribute("weight", "7") == 2.0);
+    }
+}
+
+TEST_CASE("Reorder nodes by degree") {
+    graphw::Graph graph;
+    graph.add_path({"a", "b", "c"});
+    graph.add_star(4);
+    CHECK(graph.reorder(graphw::Ordering::degree)[0] == 3);
+    CHECK(graph.label(0) == "3");
+}
+
+TEST_CASE("Reverse Cuthill-McKee reduces bandwidth") {
+    // A path added out of order
+    graphw::Graph graph;
+    for (int i = 0; i < 100; i++) {
+        graph.add_node(std::to_string((i * 37) % 100));
+    }
+    for (int i = 0; i < 99; i++) {
+        graph.add_edge(std::to_string(i), std::to_string(i + 1));
+    }
+    graph.reorder(graphw::Ordering::reverse_cuthill_mckee);
+    graphw::NodeId bandwidth = 0;
+    for (graphw::NodeId i = 0; i < graph.number_of_nodes(); i++) {
+        for (auto const& neighbor : graph.graph[i]) {
+            bandwidth = std::max(bandwidth, std::abs(neighbor.id - i));
+        }
+    }
+    CHECK(bandwidth == 1);
+}
+
+TEST_CASE("Id and count types") {
+#ifdef GRAPHW_64BIT_IDS
+    CHECK(sizeof(graphw::NodeId) == 8);
+#else
+    CHECK(sizeof(graphw::NodeId) == 4);
+#endif
+    CHECK(sizeof(graphw::EdgeCount) == 8);
+
+    // Sizes are computed without overflowing or rounding
+    graphw::Graph graph;
+    graph.add_balanced_tree(3, 9);
+    CHECK(graph.number_of_nodes() == 29524);
+    CHECK(graph.number_of_edges() == 29523);
+
+    // Trees whose size does not fit in a node id are rejected before any
+    // node is added
+    REQUIRE_THROWS_AS(graph.add_balanced_tree(2, 64), std::overflow_error);
+    REQUIRE_THROWS_AS(
+        graph.add_balanced_tree(std::numeric_limits<graphw::NodeId>::max(), 2),
+        std::overflow_error);
+    CHECK(graph.number_of_nodes() == 29524);
+}
+
+TEST_CASE("In-edges of a directed graph") {
+    for (bool indexed : {false, true}) {
+        graphw::Graph graph(true);
+        graph.set_in_edge_index(indexed);
+        graph.add_edge("a", "c");
+        graph.add_edge("b", "c");
+        graph.add_edge("c", "e");
+        graph.add_node("d");
+        graph.add_path({"d", "c", "c"});
+
+        CHECK(graph.in_edge_index() == indexed);
+        CHECK(graph.out_degree("c") == 2);
+        CHECK(graph.in_degree("c") == 4);
+        CHECK(graph.in_degree("d") == 0);
+        CHECK(graph.in_neighbors("e") == std::list<std::string>{"c"});
+        CHECK(graph.predecessors("c").size() == 4);
+        REQUIRE_THROWS(graph.in_degree("f"));
+    }
+}
+
+TEST_CASE("In-edge index after reordering") {
+    graphw::Graph graph(true);
+    graph.add_edge("a", "b");
+    graph.add_edge("c", "b");
+    graph.set_in_edge_index(true);
+    graph.add_edge("b", "d");
+    graph.reorder(graphw::Ordering::degree);
+
+    CHECK(graph.in_degree("b") == 2);
+    CHECK(graph.in_neighbors("d") == std::list<std::string>{"b"});
+    graph.set_in_edge_index(false);
+    CHECK(graph.in_degree("b") == 2);
+}
+
+TEST_CASE("Dense adjacency matrix") {
+    graphw::Graph sparse;
+    sparse.add_turan(100, 3);
+    sparse.add_edge("7", "7");
+    graphw::Graph dense;
+    dense.set_dense_threshold(0.05);
+    dense.add_turan(100, 3);
+    dense.add_edge("7", "7");
+
+    CHECK_FALSE(sparse.dense());
+    CHECK(dense.dense());
+    CHECK(dense.number_of_edges() == sparse.number_of_edges());
+    CHECK(dense.get_adjacency_list() == sparse.get_adjacency_list());
+    for (std::string label : {"0", "7", "50", "99"}) {
+        CHECK(dense.get_non_neighbors(label) ==
+              sparse.get_non_neighbors(label));
+        CHECK(dense.get_common_neighbors(label, "1") ==
+              sparse.get_common_neighbors(label, "1"));
+        CHECK(dense.has_edge(label, "3") == sparse.has_edge(label, "3"));
+        CHECK(dense.has_edge("4", label) == sparse.has_edge("4", label));
+    }
+    CHECK(dense.has_edge("7", "7"));
+    REQUIRE_THROWS(dense.has_edge("7", "missing"));
+
+    // Nodes added after switching grow the matrix
+    for (int i = 0; i < 100; i++) {
+        dense.add_edge(std::to_string(i), "x" + std::to_string(i));
+    }
+    CHECK(dense.has_edge("x99", "99"));
+    CHECK_FALSE(dense.has_edge("x99", "98"));
+    CHECK(dense.get_non_neighbors("x0").size() == 198);
+    dense.reorder(graphw::Ordering::degree);
+    CHECK(dense.has_edge("x5", "5"));
+    CHECK(dense.get_common_neighbors("0", "x0").empty());
+
+    // The matrix keeps the order of the neighbors of the first node
+    graphw::Graph square;
+    square.add_empty(4);
+    square.add_edge("0", "3");
+    square.add_edge("0", "2");
+    square.add_edge("1", "2");
+    square.add_edge("1", "3");
+    CHECK_FALSE(square.dense());
+    CHECK(square.get_common_neighbors("0", "1") ==
+          std::list<std::string>{"3", "2"});
+    // Repeated edges added by id are listed once per edge
+    square.add_edge(0, 3);
+    CHECK(square.get_common_neighbors("0", "1") ==
+          std::list<std::string>{"3", "2", "3"});
+    square.set_dense(true);
+    CHECK(square.get_common_neighbors("0", "1") ==
+          std::list<std::string>{"3", "2", "3"});
+}
+
+TEST_CASE("Dense directed graph") {
+    graphw::Graph graph(true);
+    graph.add_node("a");
+    graph.add_node("b");
+    graph.add_edge("a", "b");
+    graph.set_dense(true);
+
+    CHECK(graph.dense());
+    CHECK(graph.has_edge("a", "b"));
+    CHECK_FALSE(graph.has_edge("b", "a"));
+    CHECK(graph.get_non_neighbors("b") == std::list<std::string>{"a"});
+    // Like adjacency lists, the matrix treats an edge in either direction as
+    // an existing edge
+    graph.add_edge("b", "a");
+    CHECK_FALSE(graph.has_edge("b", "a"));
+    graph.set_dense(false);
+    CHECK_FALSE(graph.has_edge("b", "a"));
+}
+
+TEST_CASE("Integer labelled graph") {
+    graphw::BasicGraph<graphw::Undirected, graphw::IntegerLabels> graph;
+    graph.add_edge(0, 5);
+    graph.add_edge("7", "2");
+    graph.add_edge("2", "7");
+
+    CHECK(sizeof(decltype(graph)::Node) == sizeof(graphw::NodeId));
+    CHECK_FALSE(graph.directed());
+    CHECK(graph.number_of_nodes() == 8);
+    CHECK(graph.number_of_edges() == 3);
+    CHECK(graph.label(5) == "5");
+    CHECK(graph.id("7") == 7);
+    CHECK(graph.get_neighbors("5") == std::list<std::string>{"0"});
+    CHECK(graph.degree("7") == 1);
+    CHECK(graph.get_adjacency_list() ==
+          "0 5 \n1 \n2 7 \n3 \n4 \n5 0 \n6 \n7 2 \n");
+    REQUIRE_THROWS(graph.add_node("3"));
+    REQUIRE_THROWS(graph.add_node("x"));
+    REQUIRE_THROWS(graph.degree("8"));
+    REQUIRE_THROWS(graph.degree("07"));
+    REQUIRE_THROWS(graph.set_directed(true));
+    // A label which is not an integer does not count as an edge
+    REQUIRE_THROWS(graph.add_edge("x", "1"));
+    REQUIRE_THROWS(graph.add_edge("1", "x"));
+    CHECK(graph.number_of_edges() == 3);
+    CHECK(graph.add_node().id == 8);
+
+    graph.clear();
+    graph.set_dense_threshold(0.05);
+    graph.add_complete(100);
+    graph.set_in_edge_index(true);
+    CHECK(graph.dense());
+    CHECK(graph.number_of_edges() == 4950);
+    CHECK(graph.in_degree("42") == 99);
+    CHECK(graph.get_common_neighbors("0", "1").size() == 98);
+    graph.reorder(graphw::Ordering::degree);
+    CHECK(graph.has_edge("3", "4"));
+
+    // Reordering relabels nodes by their new id
+    graph.clear();
+    graph.add_path({"0", "1", "2"});
+    graph.add_edge("3", "1");
+    std::vector<graphw::NodeId> order =
+        graph.reorder(graphw::Ordering::degree);
+    CHECK(order[0] == 1);
+    CHECK(graph.degree("0") == 3);
+    CHECK(graph.get_adjacency_list() == "0 1 2 3 \n1 0 \n2 0 \n3 0 \n");
+}
+
+TEST_CASE("Directed graph with edge payloads") {
+    graphw::BasicGraph<graphw::Directed, graphw::StringLabels, int64_t, float>
+        graph;
+    graph.add_edge("a", "b", 2.5);
+    graph.add_edge("b", "c", 1.5);
+    graph.add_edge(2, 0, 0.5);
+
+    CHECK(graph.directed());
+    CHECK(graph.graph[0][0].label == "b");
+    CHECK(graph.graph[0][0].payload == 2.5);
+    CHECK(graph.graph[2][0].payload == 0.5);
+    CHECK(graph.has_edge("c", "a"));
+    CHECK_FALSE(graph.has_edge("a", "c"));
+    CHECK(graph.in_neighbors("a") == std::list<std::string>{"c"});
+    REQUIRE_THROWS(graph.add_edge(0, 3));
+    REQUIRE_THROWS(graph.set_directed(false));
+    REQUIRE_THROWS(
+        graphw::BasicGraph<graphw::Undirected>(true).number_of_nodes());
+
+    std::vector<int64_t> order = graph.reorder(graphw::Ordering::degree);
+    CHECK(order.size() == 3);
+    CHECK(graph.has_edge("a", "b"));
+    CHECK(graph.graph[graph.id("a")][0].payload == 2.5);
+}
+
+TEST_CASE("Layouts keep their direction") {
+    CHECK(graphw::CircularLayout(true).directed());
+    CHECK(graphw::ForceDirectedLayout(true).directed());
+    CHECK(graphw::ArcDiagram(true).directed());
+    CHECK_FALSE(graphw::SpiralLayout().directed());
+}
+
+TEST_CASE("Structural version") {
+    graphw::Graph graph;
+    CHECK(graph.version() == 0);
+    graph.add_node("a");
+    graph.add_edge("a", "b");
+    CHECK(graph.version() == 4);
+    graph.add_edge("b", "a");
+    graph.set_attribute("weight", "a", 1.0);
+    CHECK(graph.version() == 4);
+    graph.set_directed(true);
+    CHECK(graph.version() == 5);
+    graph.reorder(graphw::Ordering::degree);
+    CHECK(graph.version() == 6);
+    graph.clear();
+    CHECK(graph.version() == 7);
+}
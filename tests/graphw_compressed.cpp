@@ -0,0 +1,84 @@
+#include "graphw_compressed.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <list>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_csr.hpp"
+
+// Return the breadth first distances from node 0 of any graph with neighbors
+template <typename G>
+std::vector<graphw::NodeId> distances(const G& g) {
+    std::vector<graphw::NodeId> result(g.number_of_nodes(), -1);
+    std::queue<int> queue;
+    result[0] = 0;
+    queue.push(0);
+    while (!queue.empty()) {
+        int id = queue.front();
+        queue.pop();
+        for (int neighbor_id : g.neighbors(id)) {
+            if (result[neighbor_id] < 0) {
+                result[neighbor_id] = result[id] + 1;
+                queue.push(neighbor_id);
+            }
+        }
+    }
+    return result;
+}
+
+TEST_CASE("Construct compressed graph") {
+    graphw::Graph graph;
+    graph.add_circulant(300, {1, 5, 100});
+    graph.add_edge("299", "0");
+    graph.add_edge("x", "x");
+    graph.add_star(200);
+    graphw::CSRGraph csr(graph);
+    graphw::CompressedGraph compressed(graph);
+
+    CHECK(compressed.number_of_nodes() == csr.number_of_nodes());
+    CHECK(compressed.number_of_edges() == csr.number_of_edges());
+    CHECK(compressed.average_degree() == csr.average_degree());
+    for (int i = 0; i < csr.number_of_nodes(); i++) {
+        std::vector<graphw::NodeId> expected(csr.neighbors(i).begin(),
+                                  csr.neighbors(i).end());
+        std::sort(expected.begin(), expected.end());
+        std::vector<graphw::NodeId> actual(compressed.neighbors(i).begin(),
+                                compressed.neighbors(i).end());
+        CHECK(actual == expected);
+        CHECK(compressed.neighbors(i).size() == expected.size());
+        CHECK(compressed.label(i) == csr.label(i));
+    }
+    CHECK(distances(compressed) == distances(csr));
+    CHECK(compressed.degree("x") == csr.degree("x"));
+    CHECK(compressed.get_common_neighbors("0", "2") ==
+          std::list<std::string>{"1"});
+    REQUIRE_THROWS(compressed.degree("missing"));
+}
+
+TEST_CASE("Compressed graph is smaller than CSR") {
+    graphw::Graph graph;
+    graph.add_circulant(10000, {1, 2, 3, 4});
+    graphw::CompressedGraph compressed(graph);
+
+    CHECK(compressed.adjacency_bytes() <
+          graph.number_of_edges() * 2 * sizeof(int) / 3);
+    CHECK(compressed.get_adjacency_list().size() ==
+          graph.get_adjacency_list().size());
+}
+
+TEST_CASE("Compress unlabelled CSR graph") {
+    std::vector<uint64_t> offsets = {0, 2, 2, 3};
+    std::vector<graphw::NodeId> targets = {2, 1, 0};
+    graphw::CSRGraph csr(std::move(offsets), std::move(targets), true);
+    graphw::CompressedGraph compressed(csr);
+
+    CHECK(!compressed.has_labels());
+    CHECK(compressed.get_neighbors("0") == std::list<std::string>{"1", "2"});
+    CHECK(compressed.degree("1") == 0);
+    CHECK(compressed.id("2") == 2);
+    REQUIRE_THROWS(compressed.id("3"));
+}
@@ -0,0 +1,173 @@
+#include "graphw_concurrent.hpp"
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_csr.hpp"
+
+TEST_CASE("Add edges from multiple threads") {
+    graphw::ConcurrentGraphBuilder builder(false, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&builder, t]() {
+            for (int i = t; i < 1000; i += 4) {
+                builder.add_edge("hub", std::to_string(i));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    builder.add_node("isolated");
+
+    CHECK(builder.number_of_nodes() == 1002);
+    CHECK(builder.number_of_edges() == 1000);
+    graphw::Graph graph = builder.build();
+    CHECK(graph.number_of_nodes() == 1002);
+    CHECK(graph.number_of_edges() == 1000);
+    CHECK(graph.degree("hub") == 1000);
+    CHECK(graph.degree("999") == 1);
+    CHECK(graph.degree("isolated") == 0);
+    CHECK(builder.number_of_nodes() == 0);
+}
+
+TEST_CASE("Deterministic build") {
+    auto build = [](bool reversed) {
+        graphw::ConcurrentGraphBuilder builder(true);
+        for (int i = 0; i < 20; i++) {
+            int j = reversed ? 19 - i : i;
+            builder.add_edge(std::to_string(j), std::to_string((j * 7) % 20));
+            builder.add_edge(std::to_string(j), std::to_string((j + 1) % 20));
+        }
+        return builder.build(true);
+    };
+    graphw::Graph graph1 = build(false);
+    graphw::Graph graph2 = build(true);
+
+    CHECK(graph1.get_adjacency_list() == graph2.get_adjacency_list());
+    CHECK(graph1.label(10) == "10");
+    CHECK(graph1.get_neighbors("3") == std::list<std::string>{"1", "4"});
+}
+
+TEST_CASE("Build CSR graph from builder") {
+    graphw::ConcurrentGraphBuilder builder1, builder2;
+    for (int i = 0; i < 50; i++) {
+        for (graphw::ConcurrentGraphBuilder* builder : {&builder1, &builder2}) {
+            builder->add_edge(std::to_string(i), std::to_string(i * i % 50));
+        }
+    }
+    graphw::Graph graph = builder1.build(true);
+    graphw::CSRGraph csr = builder2.build_csr(true);
+
+    CHECK(csr.number_of_nodes() == graph.number_of_nodes());
+    CHECK(csr.number_of_edges() == graph.number_of_edges());
+    CHECK(csr.get_adjacency_list() == graph.get_adjacency_list());
+    CHECK(csr.id("7") == 7);
+}
+
+TEST_CASE("Versioned graph snapshots") {
+    graphw::VersionedGraph graph;
+    graph.add_edge("a", "b");
+    graphw::VersionedGraph::Snapshot empty = graph.snapshot();
+    graph.publish();
+    graphw::VersionedGraph::Snapshot first = graph.snapshot();
+    graph.add_edge("a", "c");
+    graph.add_edge("c", "a");
+    graph.add_node("d");
+    graph.publish();
+    graphw::VersionedGraph::Snapshot second = graph.snapshot();
+
+    CHECK(empty.number_of_nodes() == 0);
+    CHECK(first.number_of_nodes() == 2);
+    CHECK(first.get_neighbors("a") == std::list<std::string>{"b"});
+    REQUIRE_THROWS(first.degree("c"));
+    CHECK(second.number_of_nodes() == 4);
+    CHECK(second.number_of_edges() == 2);
+    CHECK(second.get_neighbors("a") == std::list<std::string>{"b", "c"});
+    CHECK(second.get_common_neighbors("b", "c") ==
+          std::list<std::string>{"a"});
+    CHECK(second.degree("d") == 0);
+    REQUIRE_THROWS(graph.add_node("d"));
+}
+
+TEST_CASE("Read versioned graph while writing") {
+    graphw::VersionedGraph graph(false, 8);
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                graphw::VersionedGraph::Snapshot snapshot = graph.snapshot();
+                // Edges are published a whole star at a time
+                int nodes = snapshot.number_of_nodes();
+                int edges = snapshot.number_of_edges();
+                if (nodes % 11 != 0 || edges != nodes - nodes / 11) {
+                    failures++;
+                }
+                if (nodes > 0 && snapshot.degree("0") != 10) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (int star = 0; star < 200; star++) {
+        std::string center = std::to_string(star * 11);
+        for (int i = 1; i <= 10; i++) {
+            graph.add_edge(center, std::to_string(star * 11 + i));
+        }
+        graph.publish();
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    CHECK(failures == 0);
+    CHECK(graph.snapshot().number_of_nodes() == 2200);
+}
+
+TEST_CASE("Query graph from multiple threads") {
+    graphw::Graph graph;
+    graph.add_circulant(500, {1, 2, 5});
+    graph.set_attribute("weight", "3", 1.5);
+    const graphw::Graph& shared = graph;
+    const std::string adjacency_list = graph.get_adjacency_list();
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&shared, &adjacency_list, &failures, t]() {
+            for (int i = t; i < 500; i += 8) {
+                std::string label = std::to_string(i);
+                std::string next = std::to_string((i + 1) % 500);
+                if (shared.degree(label) != 6 ||
+                    shared.get_neighbors(label).size() != 6 ||
+                    shared.get_non_neighbors(label).size() != 493 ||
+                    shared.get_common_neighbors(label, next).size() != 2 ||
+                    shared.average_degree() != 6.0f ||
+                    shared.attribute("weight", label) != (i == 3 ? 1.5 : 0)) {
+                    failures++;
+                }
+            }
+            if (shared.get_adjacency_list() != adjacency_list) {
+                failures++;
+            }
+            try {
+                shared.degree("missing");
+                failures++;
+            } catch (const graphw::GraphwError&) {
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(failures == 0);
+    CHECK(graph.number_of_nodes() == 500);
+}
@@ -0,0 +1,198 @@
+#include "graphw_csr.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <vector>
+
+#include "graphw.hpp"
+
+TEST_CASE("Construct CSR graph from graph") {
+    graphw::Graph graph;
+    graph.add_edge("a", "b");
+    graph.add_edge("a", "c");
+    graph.add_star(3);
+    graphw::CSRGraph csr(graph);
+
+    CHECK(csr.number_of_nodes() == graph.number_of_nodes());
+    CHECK(csr.number_of_edges() == graph.number_of_edges());
+    CHECK(csr.degree("a") == 2);
+    CHECK(csr.get_neighbors("a") == graph.get_neighbors("a"));
+    CHECK(csr.get_adjacency_list() == graph.get_adjacency_list());
+    CHECK(csr.id("c") == 2);
+    REQUIRE_THROWS(csr.degree("missing"));
+}
+
+TEST_CASE("Snapshot round trip") {
+    const std::string path = "graphw_test_snapshot.bin";
+    graphw::Graph graph(true);
+    graph.add_circulant(20, {1, 3});
+    graph.set_attribute("weight", "4", 2.5);
+    graph.set_attribute("size", "0", -1.0);
+    graphw::CSRGraph(graph).write_snapshot(path);
+
+    graphw::CSRGraph loaded = graphw::CSRGraph::load_snapshot(path, true);
+    std::remove(path.c_str());
+
+    CHECK(loaded.directed());
+    CHECK(loaded.number_of_nodes() == graph.number_of_nodes());
+    CHECK(loaded.number_of_edges() == graph.number_of_edges());
+    CHECK(loaded.get_adjacency_list() == graph.get_adjacency_list());
+    CHECK(loaded.attribute_names() == graph.attribute_names());
+    CHECK(loaded.attribute("weight", "4") == 2.5);
+    CHECK(loaded.attribute("weight", "5") == 0.0);
+    CHECK(loaded.attribute("size", "0") == -1.0);
+}
+
+TEST_CASE("Snapshot with corrupted data") {
+    const std::string path = "graphw_test_corrupted_snapshot.bin";
+    graphw::Graph graph;
+    graph.add_complete(10);
+    graphw::CSRGraph(graph).write_snapshot(path);
+    {
+        // Overwrite the last byte of the file, which belongs to the label
+        // order section
+        std::fstream file(path,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('\x7f');
+    }
+    CHECK_NOTHROW(graphw::CSRGraph::load_snapshot(path));
+    CHECK_THROWS(graphw::CSRGraph::load_snapshot(path, true));
+    std::remove(path.c_str());
+}
+
+// Overwrite value at offset into a section of a snapshot and update its
+// checksums, so that only the structural checks can catch the corruption
+template <typename T>
+void patch_snapshot(const std::string& path, size_t section, uint64_t offset,
+                    T value) {
+    std::string data;
+    {
+        std::ifstream file(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+    }
+    graphw::detail::SnapshotHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    std::vector<graphw::detail::SnapshotSection> sections(header.section_count);
+    const size_t table_size =
+        sections.size() * sizeof(graphw::detail::SnapshotSection);
+    memcpy(sections.data(), data.data() + sizeof(header), table_size);
+    memcpy(&data[sections[section].offset + offset], &value, sizeof(value));
+    sections[section].checksum = graphw::detail::checksum(
+        data.data() + sections[section].offset, sections[section].size);
+    header.checksum = 0;
+    header.checksum = graphw::detail::checksum(
+        sections.data(), table_size,
+        graphw::detail::checksum(&header, sizeof(header)));
+    memcpy(&data[0], &header, sizeof(header));
+    memcpy(&data[sizeof(header)], sections.data(), table_size);
+    std::ofstream file(path, std::ios::binary);
+    file << data;
+}
+
+TEST_CASE("Snapshot with inconsistent arrays") {
+    const std::string path = "graphw_test_inconsistent_snapshot.bin";
+    graphw::Graph graph;
+    graph.add_complete(10);
+    graphw::CSRGraph csr(graph);
+
+    SECTION("Last label offset past the label characters") {
+        csr.write_snapshot(path);
+        patch_snapshot(path, graphw::detail::label_offsets_section,
+                       10 * sizeof(uint64_t), (uint64_t)(1000));
+        CHECK_THROWS(graphw::CSRGraph::load_snapshot(path));
+    }
+    SECTION("Decreasing label offset") {
+        csr.write_snapshot(path);
+        patch_snapshot(path, graphw::detail::label_offsets_section,
+                       5 * sizeof(uint64_t), (uint64_t)(1000));
+        CHECK_NOTHROW(graphw::CSRGraph::load_snapshot(path));
+        CHECK_THROWS(graphw::CSRGraph::load_snapshot(path, true));
+    }
+    SECTION("Label order id out of range") {
+        csr.write_snapshot(path);
+        patch_snapshot(path, graphw::detail::label_order_section,
+                       3 * sizeof(graphw::NodeId), (graphw::NodeId)(10));
+        CHECK_THROWS(graphw::CSRGraph::load_snapshot(path, true));
+    }
+    SECTION("Neighbor id out of range") {
+        csr.write_snapshot(path);
+        patch_snapshot(path, graphw::detail::targets_section, 0,
+                       (graphw::NodeId)(-1));
+        CHECK_THROWS(graphw::CSRGraph::load_snapshot(path, true));
+    }
+    SECTION("Truncated file") {
+        csr.write_snapshot(path);
+        std::string data;
+        {
+            std::ifstream file(path, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file),
+                        std::istreambuf_iterator<char>());
+        }
+        std::ofstream file(path, std::ios::binary);
+        file << data.substr(0, data.size() / 2);
+        file.close();
+        CHECK_THROWS(graphw::CSRGraph::load_snapshot(path));
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Snapshot with invalid header") {
+    const std::string path = "graphw_test_invalid_snapshot.bin";
+    {
+        std::ofstream file(path);
+        file << "not a snapshot, but long enough to hold a header";
+    }
+    CHECK_THROWS(graphw::CSRGraph::load_snapshot(path));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Borrow CSR arrays") {
+    std::vector<uint64_t> offsets = {0, 2, 3, 4};
+    std::vector<graphw::NodeId> targets = {1, 2, 0, 0};
+    graphw::CSRGraph csr(3, offsets.data(), targets.data(), false);
+
+    CHECK(csr.number_of_nodes() == 3);
+    CHECK(csr.number_of_edges() == 2);
+    CHECK(csr.neighbors(0).begin() == targets.data());
+    CHECK(csr.get_neighbors("0") == std::list<std::string>{"1", "2"});
+    REQUIRE_THROWS(csr.degree("3"));
+}
+
+TEST_CASE("Own CSR arrays") {
+    std::vector<uint64_t> offsets = {0, 1, 2};
+    std::vector<graphw::NodeId> targets = {1, 1};
+    const graphw::NodeId* data = targets.data();
+    graphw::CSRGraph csr(std::move(offsets), std::move(targets), true);
+
+    CHECK(csr.number_of_edges() == 2);
+    CHECK(csr.neighbors(0).begin() == data);
+    CHECK(csr.degree("1") == 1);
+}
+
+TEST_CASE("Invalid CSR arrays") {
+    std::vector<uint64_t> offsets = {0, 1, 2};
+    std::vector<graphw::NodeId> targets = {1, 5};
+    REQUIRE_THROWS(
+        graphw::CSRGraph(2, offsets.data(), targets.data(), true));
+    REQUIRE_THROWS(graphw::CSRGraph(std::vector<uint64_t>{0, 3},
+                                    std::vector<graphw::NodeId>{0}, true));
+}
+
+TEST_CASE("Construct CSR graph from COO arrays") {
+    std::vector<graphw::NodeId> rows = {0, 2, 1, 3};
+    std::vector<graphw::NodeId> columns = {1, 0, 1, 0};
+    graphw::CSRGraph csr =
+        graphw::CSRGraph::from_coo(4, rows.data(), columns.data(), 4, false);
+
+    CHECK(csr.number_of_edges() == 4);
+    CHECK(csr.get_neighbors("0") == std::list<std::string>{"1", "2", "3"});
+    CHECK(csr.get_neighbors("1") == std::list<std::string>{"0", "1"});
+    REQUIRE_THROWS(
+        graphw::CSRGraph::from_coo(2, rows.data(), columns.data(), 4, true));
+}
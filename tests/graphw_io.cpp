@@ -0,0 +1,155 @@
+#include "graphw_io.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <sstream>
+#include <vector>
+
+#include "graphw.hpp"
+
+TEST_CASE("Write DOT") {
+    graphw::Graph graph;
+    graph.add_edge("a", "b");
+    graph.add_edge("b", "b");
+    graph.set_attribute("weight", "a", 0.5);
+    std::vector<graphw::PositionFloat> positions = {{1, 2}, {3.5, 4}};
+
+    std::ostringstream stream;
+    graphw::write_dot(graph, stream, positions);
+    CHECK(stream.str() ==
+          "graph {\n"
+          "  \"a\" [pos=\"1,2!\", \"weight\"=0.5];\n"
+          "  \"b\" [pos=\"3.5,4!\", \"weight\"=0];\n"
+          "  \"a\" -- \"b\";\n"
+          "  \"b\" -- \"b\";\n"
+          "}\n");
+}
+
+TEST_CASE("Write JSON") {
+    graphw::Graph graph(true);
+    graph.add_edge("a", "\"b\"");
+    graph.add_node("c");
+
+    std::ostringstream stream;
+    graphw::write_json(graph, stream);
+    CHECK(stream.str() ==
+          "{\"directed\": true, \"multigraph\": false, \"graph\": {}, "
+          "\"nodes\": [\n"
+          "{\"id\": \"a\"}\n"
+          ",{\"id\": \"\\\"b\\\"\"}\n"
+          ",{\"id\": \"c\"}\n"
+          "], \"links\": [\n"
+          "{\"source\": \"a\", \"target\": \"\\\"b\\\"\"}\n"
+          "]}\n");
+}
+
+TEST_CASE("Write GraphML") {
+    graphw::Graph graph;
+    graph.add_edge("a", "<b>");
+
+    std::ostringstream stream;
+    graphw::write_graphml(graph, stream);
+    std::string graphml = stream.str();
+    CHECK(graphml.find("edgedefault=\"undirected\"") != std::string::npos);
+    CHECK(graphml.find("<node id=\"&lt;b&gt;\"/>") != std::string::npos);
+    CHECK(graphml.find("<edge source=\"a\" target=\"&lt;b&gt;\"/>") !=
+          std::string::npos);
+}
+
+TEST_CASE("Write GEXF") {
+    graphw::Graph graph;
+    graph.add_complete(4);
+
+    std::ostringstream stream;
+    graphw::write_gexf(graph, stream);
+    std::string gexf = stream.str();
+    size_t edges = 0;
+    for (size_t i = gexf.find("<edge "); i != std::string::npos;
+         i = gexf.find("<edge ", i + 1)) {
+        edges++;
+    }
+    CHECK(edges == 6);
+}
+
+TEST_CASE("Write formats in parallel") {
+    graphw::Graph graph;
+    graph.add_circulant(3000, {1, 5});
+    graph.set_attribute("weight", "7", 2.0);
+    std::vector<graphw::Position> positions(3000, {1, 1});
+
+    std::ostringstream sequential, parallel;
+    graphw::write_json(graph, sequential, positions);
+    graphw::write_json(graph, parallel, positions, true);
+    CHECK(sequential.str() == parallel.str());
+}
+
+TEST_CASE("Write with mismatched positions") {
+    graphw::Graph graph;
+    graph.add_complete(3);
+    std::vector<graphw::PositionFloat> positions(2);
+
+    std::ostringstream stream;
+    REQUIRE_THROWS(graphw::write_dot(graph, stream, positions));
+}
+
+TEST_CASE("Read Matrix Market") {
+    const std::string path = "graphw_test_matrix.mtx";
+    {
+        std::ofstream file(path);
+        file << "%%MatrixMarket matrix coordinate real symmetric\n"
+                "% comment\n"
+                "4 4 4\n"
+                "2 1 0.5\n"
+                "3 1 1.0\n"
+                "4 4 2.0\n"
+                "4 2 -1\n";
+    }
+    graphw::CSRGraph csr = graphw::read_matrix_market(path);
+    std::remove(path.c_str());
+
+    CHECK_FALSE(csr.directed());
+    CHECK(csr.number_of_nodes() == 4);
+    CHECK(csr.number_of_edges() == 4);
+    CHECK(csr.get_neighbors("0") == std::list<std::string>{"1", "2"});
+    CHECK(csr.get_neighbors("3") == std::list<std::string>{"3", "1"});
+}
+
+TEST_CASE("Read invalid Matrix Market") {
+    const std::string path = "graphw_test_invalid_matrix.mtx";
+    {
+        std::ofstream file(path);
+        file << "%%MatrixMarket matrix coordinate pattern general\n"
+                "2 2 2\n"
+                "1 2\n"
+                "3 1\n";
+    }
+    REQUIRE_THROWS(graphw::read_matrix_market(path));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Matrix Market round trip") {
+    const std::string path = "graphw_test_round_trip.mtx";
+    graphw::Graph graph;
+    graph.add_barbell(4, 2);
+    graph.add_edge("0", "0");
+    {
+        std::ofstream file(path);
+        graphw::write_matrix_market(graphw::CSRGraph(graph), file, true);
+    }
+    graphw::CSRGraph csr = graphw::read_matrix_market(path);
+    std::remove(path.c_str());
+
+    CHECK(csr.number_of_nodes() == graph.number_of_nodes());
+    CHECK(csr.number_of_edges() == graph.number_of_edges());
+    for (int i = 0; i < graph.number_of_nodes(); i++) {
+        std::list<std::string> expected = graph.get_neighbors(graph.label(i));
+        std::list<std::string> result = csr.get_neighbors(graph.label(i));
+        expected.sort();
+        result.sort();
+        // Graph stores an undirected self loop twice
+        expected.unique();
+        CHECK(result == expected);
+    }
+}
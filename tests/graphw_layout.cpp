@@ -0,0 +1,639 @@
+#include "graphw_layout.hpp"
+
+#include <stdlib.h>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "graphw.hpp"
+
+TEST_CASE("Fixed layouts") {
+    graphw::ArcDiagram arc;
+    CHECK(graphw::compute_layout(arc, 400, 300).empty());
+    arc.add_cycle({"a", "b", "c", "d"});
+    std::vector<graphw::PositionFloat> positions =
+        graphw::compute_layout(arc, 400, 300);
+    REQUIRE(positions.size() == 4);
+    CHECK(graphw::arc_node_radius(arc, 400) == 25);
+    CHECK(positions[0].x == 50);
+    CHECK(positions[3].x == 350);
+    CHECK(positions[2].y == 150);
+
+    graphw::CircularLayout circular(false, 10);
+    circular.add_empty(4);
+    positions = graphw::compute_layout(circular, 200, 300);
+    REQUIRE(positions.size() == 4);
+    CHECK(positions[0].x == Approx(185));
+    CHECK(positions[0].y == Approx(150));
+    CHECK(positions[1].x == Approx(100).margin(0.001));
+    CHECK(positions[1].y == Approx(235));
+
+    graphw::SpiralLayout spiral(false, 10);
+    spiral.add_empty(50);
+    positions = graphw::compute_layout(spiral, 300, 200);
+    REQUIRE(positions.size() == 50);
+    CHECK(positions[0].x == 150);
+    CHECK(positions[0].y == 100);
+    float max = 0;
+    for (const graphw::PositionFloat& position : positions) {
+        max = std::max(max, std::fabs(position.y - 100));
+    }
+    CHECK(max == Approx(80));
+    spiral.set_equidistant(true);
+    CHECK(graphw::compute_layout(spiral, 300, 200).size() == 50);
+    spiral = graphw::SpiralLayout(false, 10);
+    spiral.add_empty(1);
+    CHECK(graphw::compute_layout(spiral, 300, 200)[0].x == 150);
+}
+
+TEST_CASE("Arc diagram follows reordered ids") {
+    // A path added out of order has long arcs until it is reordered
+    graphw::ArcDiagram arc;
+    for (int i = 0; i < 20; i++) {
+        arc.add_node(std::to_string((i * 7) % 20));
+    }
+    for (int i = 0; i < 19; i++) {
+        arc.add_edge(std::to_string(i), std::to_string(i + 1));
+    }
+    auto arc_length = [&arc]() {
+        std::vector<graphw::PositionFloat> positions =
+            graphw::compute_layout(arc, 800, 300);
+        float length = 0;
+        for (int i = 0; i < 19; i++) {
+            graphw::NodeId id1 = arc.id(std::to_string(i));
+            graphw::NodeId id2 = arc.id(std::to_string(i + 1));
+            length += std::abs(positions[id1].x - positions[id2].x);
+        }
+        return length;
+    };
+    const float spacing = 4 * graphw::arc_node_radius(arc, 800);
+    CHECK(arc_length() > 19 * spacing);
+    arc.reorder(graphw::Ordering::reverse_cuthill_mckee);
+    CHECK(arc_length() == Approx(19 * spacing));
+}
+
+TEST_CASE("Cached layouts") {
+    graphw::CircularLayout circular(false, 10);
+    circular.add_empty(8);
+    std::vector<graphw::PositionFloat> positions =
+        graphw::update_layout(circular, 200, 300);
+    REQUIRE(circular.positions().size() == 8);
+    CHECK(circular.positions()[2].y == Approx(1));
+    std::vector<graphw::PositionFloat> expected =
+        graphw::compute_layout(circular, 200, 300);
+    for (graphw::NodeId i = 0; i < 8; i++) {
+        CHECK(positions[i].x == Approx(expected[i].x));
+        CHECK(positions[i].y == Approx(expected[i].y));
+    }
+    circular.add_node();
+    CHECK(graphw::update_layout(circular, 200, 300).size() == 9);
+    CHECK(circular.positions().size() == 9);
+    CHECK(circular.positions_version() == circular.version());
+    // Any change to the graph invalidates the cache, even if the number of
+    // nodes stays the same
+    circular.set_positions(std::vector<graphw::PositionFloat>(9, {1, 1}),
+                           circular.version());
+    CHECK(graphw::update_layout(circular, 200, 300)[0].y == Approx(235));
+    circular.add_edge("0", "1");
+    CHECK(graphw::update_layout(circular, 200, 300)[0].y == Approx(150));
+
+    graphw::SpiralLayout spiral(false, 10);
+    spiral.add_empty(50);
+    graphw::update_layout(spiral, 300, 200);
+    REQUIRE(spiral.positions().size() == 50);
+    // Resizing only scales the cached positions
+    spiral.set_positions(std::vector<graphw::PositionFloat>(50, {1, 1}),
+                         spiral.version());
+    positions = graphw::update_layout(spiral, 600, 400);
+    CHECK(positions[10].x == Approx(300 + 180));
+    CHECK(positions[10].y == Approx(200 + 180));
+    // Changing the spiral clears the cached positions
+    spiral.set_resolution(0.5);
+    CHECK(spiral.positions().empty());
+    positions = graphw::update_layout(spiral, 300, 200);
+    expected = graphw::compute_layout(spiral, 300, 200);
+    for (graphw::NodeId i = 0; i < 50; i++) {
+        CHECK(positions[i].x == expected[i].x);
+        CHECK(positions[i].y == expected[i].y);
+    }
+    spiral.set_equidistant(true);
+    CHECK(spiral.positions().empty());
+}
+
+TEST_CASE("Random and force directed layouts") {
+    srand(7);
+    graphw::RandomLayout random(false, 10);
+    random.add_empty(100);
+    std::vector<graphw::PositionFloat> positions =
+        graphw::compute_layout(random, 400, 300);
+    REQUIRE(positions.size() == 100);
+    for (const graphw::PositionFloat& position : positions) {
+        CHECK(position.x >= 10);
+        CHECK(position.x <= 400);
+        CHECK(position.y >= 10);
+        CHECK(position.y <= 300);
+    }
+
+    graphw::ForceDirectedLayout force_directed(false, 10, 50);
+    CHECK(graphw::compute_layout(force_directed, 400, 300).empty());
+    force_directed.add_edge("0", "0");
+    positions = graphw::compute_layout(force_directed, 400, 300);
+    REQUIRE(positions.size() == 1);
+    CHECK(positions[0].x == Approx(205));
+    CHECK(positions[0].y == Approx(155));
+
+    force_directed.add_barbell(5, 2);
+    std::vector<graphw::PositionFloat> unit_positions =
+        graphw::random_positions(force_directed.number_of_nodes());
+    graphw::apply_force_directed(force_directed, unit_positions);
+    for (const graphw::PositionFloat& position : unit_positions) {
+        CHECK(position.x >= Approx(0.05));
+        CHECK(position.x <= Approx(0.95));
+        CHECK(position.y >= Approx(0.05));
+        CHECK(position.y <= Approx(0.95));
+    }
+    positions = graphw::scale_positions(unit_positions, 110, 210, 10);
+    CHECK(positions[3].x == Approx(unit_positions[3].x * 100 + 10));
+    CHECK(positions[3].y == Approx(unit_positions[3].y * 200 + 10));
+}
+
+TEST_CASE("Barnes-Hut repulsion") {
+    srand(11);
+    std::vector<graphw::PositionFloat> positions =
+        graphw::random_positions(500);
+    positions.push_back(positions[3]);
+    std::vector<float> x;
+    std::vector<float> y;
+    for (const graphw::PositionFloat& position : positions) {
+        x.push_back(position.x);
+        y.push_back(position.y);
+    }
+    graphw::detail::QuadTree tree;
+    tree.build(x.data(), y.data(), x.size());
+    for (size_t i = 0; i < x.size(); i += 50) {
+        graphw::PositionFloat exact = {0, 0};
+        for (size_t j = 0; j < x.size(); j++) {
+            float delta_x = x[i] - x[j];
+            float delta_y = y[i] - y[j];
+            float distance = std::sqrt(delta_x * delta_x + delta_y * delta_y);
+            if (distance > 0) {
+                exact.x += delta_x / (distance * distance);
+                exact.y += delta_y / (distance * distance);
+            }
+        }
+        graphw::PositionFloat opened = {0, 0};
+        tree.add_repulsion(x[i], y[i], 1, 0, opened.x, opened.y);
+        CHECK(opened.x == Approx(exact.x).epsilon(0.001));
+        CHECK(opened.y == Approx(exact.y).epsilon(0.001));
+        graphw::PositionFloat approximate = {0, 0};
+        tree.add_repulsion(x[i], y[i], 1, 0.5, approximate.x, approximate.y);
+        float error = std::hypot(approximate.x - exact.x,
+                                 approximate.y - exact.y);
+        CHECK(error < 0.05 * std::hypot(exact.x, exact.y));
+    }
+
+    graphw::ForceDirectedLayout layout(false, 20, 100, true);
+    CHECK(layout.barnes_hut());
+    CHECK(layout.theta() == Approx(0.9));
+    layout.add_circular_ladder(200);
+    std::vector<graphw::PositionFloat> unit_positions =
+        graphw::random_positions(layout.number_of_nodes());
+    graphw::apply_force_directed(layout, unit_positions);
+    for (const graphw::PositionFloat& position : unit_positions) {
+        CHECK(position.x >= Approx(0.05));
+        CHECK(position.y <= Approx(0.95));
+    }
+}
+
+TEST_CASE("Multilevel force directed layout") {
+    graphw::Graph graph;
+    graph.add_ladder(4);
+    std::vector<size_t> offsets;
+    std::vector<graphw::NodeId> targets;
+    graphw::detail::symmetric_adjacency(graph, offsets, targets);
+    graphw::detail::CoarseLevel level =
+        graphw::detail::coarsen(offsets, targets, {1, 1, 1, 1, 1, 1, 1, 1});
+    CHECK(level.size() == 4);
+    CHECK(level.mass == std::vector<graphw::NodeId>{2, 2, 2, 2});
+    CHECK(level.parent[0] == level.parent[graph.graph[0][0].id]);
+    CHECK(level.offsets.back() == level.targets.size());
+    CHECK(level.offsets.back() == 6);
+
+    graphw::Graph directed(true);
+    directed.add_edge("0", "1");
+    directed.add_edge("0", "0");
+    graphw::detail::symmetric_adjacency(directed, offsets, targets);
+    CHECK(offsets == std::vector<size_t>{0, 1, 2});
+    CHECK(targets == std::vector<graphw::NodeId>{1, 0});
+
+    srand(3);
+    graphw::MultilevelForceDirectedLayout layout(false, 20, 100, 50, 20);
+    CHECK(layout.barnes_hut());
+    CHECK(layout.coarsest_size() == 50);
+    CHECK(layout.refinement_iterations() == 20);
+    CHECK(graphw::compute_layout(layout, 640, 480).empty());
+    layout.add_circular_ladder(450);
+    std::vector<graphw::PositionFloat> positions =
+        graphw::random_positions(layout.number_of_nodes());
+    graphw::apply_force_directed(layout, positions);
+    REQUIRE(positions.size() == 900);
+    float edge_length = 0;
+    for (graphw::NodeId i = 0; i < layout.number_of_nodes(); i++) {
+        CHECK(positions[i].x >= Approx(0.05));
+        CHECK(positions[i].x <= Approx(0.95));
+        for (const graphw::Node& neighbor : layout.graph[i]) {
+            const graphw::PositionFloat& other = positions[neighbor.id];
+            edge_length += std::hypot(positions[i].x - other.x,
+                                      positions[i].y - other.y);
+        }
+    }
+    // Neighbors in an untangled ring of 450 rungs are about 0.006 apart
+    edge_length /= 2 * layout.number_of_edges();
+    CHECK(edge_length < 0.03);
+
+    // Sizes below one coarsen as far as possible instead of not at all
+    layout.set_coarsest_size(-1);
+    layout.set_iterations(20);
+    positions = graphw::random_positions(layout.number_of_nodes());
+    graphw::apply_force_directed(layout, positions);
+    REQUIRE(positions.size() == 900);
+    for (const graphw::PositionFloat& position : positions) {
+        CHECK(position.x >= Approx(0.05));
+        CHECK(position.x <= Approx(0.95));
+    }
+}
+
+TEST_CASE("Vectorized force kernels") {
+    using graphw::detail::SimdLevel;
+    srand(5);
+    graphw::Graph graph;
+    graph.add_circular_ladder(250);
+    graph.add_star(20);
+    std::vector<size_t> offsets;
+    std::vector<graphw::NodeId> targets;
+    graphw::detail::symmetric_adjacency(graph, offsets, targets);
+    const graphw::NodeId nodes = graph.number_of_nodes();
+    std::vector<graphw::PositionFloat> positions =
+        graphw::random_positions(nodes);
+    positions[7] = positions[6];
+    std::vector<float> x;
+    std::vector<float> y;
+    for (const graphw::PositionFloat& position : positions) {
+        x.push_back(position.x);
+        y.push_back(position.y);
+    }
+    const float k = std::sqrt(1.0 / nodes);
+
+    graphw::detail::ForceKernels scalar(offsets, targets, SimdLevel::scalar);
+    CHECK(scalar.simd() == SimdLevel::scalar);
+    std::vector<float> expected_x(nodes, 0);
+    std::vector<float> expected_y(nodes, 0);
+    scalar.repulsion(x.data(), y.data(), expected_x.data(), expected_y.data(),
+                     nodes, k * k);
+    scalar.attraction(x.data(), y.data(), expected_x.data(), expected_y.data(),
+                      k, 0, nodes);
+    std::vector<float> expected_moved_x = x;
+    std::vector<float> expected_moved_y = y;
+    scalar.move(expected_moved_x.data(), expected_moved_y.data(),
+                expected_x.data(), expected_y.data(), 0.01, 0, nodes);
+
+    for (SimdLevel level : {SimdLevel::sse, SimdLevel::avx2}) {
+        graphw::detail::ForceKernels kernels(offsets, targets, level);
+        CHECK(kernels.simd() <= level);
+        std::vector<float> movement_x(nodes, 0);
+        std::vector<float> movement_y(nodes, 0);
+        kernels.repulsion(x.data(), y.data(), movement_x.data(),
+                          movement_y.data(), nodes, k * k);
+        kernels.attraction(x.data(), y.data(), movement_x.data(),
+                           movement_y.data(), k, 0, 300);
+        kernels.attraction(x.data(), y.data(), movement_x.data(),
+                           movement_y.data(), k, 300, nodes);
+        std::vector<float> range_x(nodes, 0);
+        std::vector<float> range_y(nodes, 0);
+        kernels.repulsion(x.data(), y.data(), range_x.data(), range_y.data(),
+                          nodes, k * k, 0, 100);
+        kernels.repulsion(x.data(), y.data(), range_x.data(), range_y.data(),
+                          nodes, k * k, 100, nodes);
+        kernels.attraction(x.data(), y.data(), range_x.data(), range_y.data(),
+                           k, 0, nodes);
+        std::vector<float> moved_x = x;
+        std::vector<float> moved_y = y;
+        kernels.move(moved_x.data(), moved_y.data(), expected_x.data(),
+                     expected_y.data(), 0.01, 0, 200);
+        kernels.move(moved_x.data(), moved_y.data(), expected_x.data(),
+                     expected_y.data(), 0.01, 200, nodes);
+        for (graphw::NodeId i = 0; i < nodes; i++) {
+            CHECK(std::isfinite(movement_x[i]));
+            CHECK(movement_x[i] == Approx(expected_x[i]).epsilon(0.001));
+            CHECK(movement_y[i] == Approx(expected_y[i]).epsilon(0.001));
+            CHECK(range_x[i] == Approx(expected_x[i]).epsilon(0.001));
+            CHECK(range_y[i] == Approx(expected_y[i]).epsilon(0.001));
+            CHECK(moved_x[i] == Approx(expected_moved_x[i]).epsilon(0.0001));
+            CHECK(moved_y[i] == Approx(expected_moved_y[i]).epsilon(0.0001));
+        }
+    }
+
+    graphw::detail::ForceOptions options;
+    options.iterations = 5;
+    std::vector<graphw::PositionFloat> scalar_positions = positions;
+    graphw::detail::force_directed_steps(offsets, targets, positions, options);
+    options.simd = SimdLevel::scalar;
+    graphw::detail::force_directed_steps(offsets, targets, scalar_positions,
+                                         options);
+    for (graphw::NodeId i = 0; i < nodes; i++) {
+        CHECK(positions[i].x == Approx(scalar_positions[i].x).margin(0.001));
+        CHECK(positions[i].y == Approx(scalar_positions[i].y).margin(0.001));
+    }
+}
+
+TEST_CASE("Multithreaded force directed layout") {
+    graphw::Graph graph;
+    graph.add_circular_ladder(2500);
+    std::vector<size_t> offsets;
+    std::vector<graphw::NodeId> targets;
+    graphw::detail::symmetric_adjacency(graph, offsets, targets);
+    CHECK(graphw::detail::layout_threads(8, 5000) == 4);
+    CHECK(graphw::detail::layout_threads(3, 5000) == 3);
+    CHECK(graphw::detail::layout_threads(0, 100) == 1);
+
+    srand(9);
+    const std::vector<graphw::PositionFloat> start =
+        graphw::random_positions(graph.number_of_nodes());
+    for (bool barnes_hut : {false, true}) {
+        graphw::detail::ForceOptions options;
+        options.iterations = 3;
+        options.barnes_hut = barnes_hut;
+        std::vector<graphw::PositionFloat> single = start;
+        graphw::detail::force_directed_steps(offsets, targets, single,
+                                             options);
+        options.threads = 3;
+        std::vector<graphw::PositionFloat> first = start;
+        graphw::detail::force_directed_steps(offsets, targets, first, options);
+        std::vector<graphw::PositionFloat> second = start;
+        graphw::detail::force_directed_steps(offsets, targets, second,
+                                             options);
+        for (graphw::NodeId i = 0; i < graph.number_of_nodes(); i++) {
+            CHECK(first[i].x == second[i].x);
+            CHECK(first[i].y == second[i].y);
+            CHECK(first[i].x == Approx(single[i].x).margin(0.001));
+            CHECK(first[i].y == Approx(single[i].y).margin(0.001));
+        }
+    }
+
+    graphw::ForceDirectedLayout layout;
+    CHECK(layout.threads() == 0);
+    layout.set_threads(2);
+    CHECK(layout.threads() == 2);
+}
+
+TEST_CASE("Barrier reports failures to every thread") {
+    // Three threads pass a barrier twice, one of them fails before the second
+    graphw::detail::Barrier barrier(4);
+    std::vector<int> failures(3, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; t++) {
+        threads.emplace_back([&, t] {
+            failures[t] += barrier.wait();
+            failures[t] += barrier.wait(t == 1);
+        });
+    }
+    // A fourth thread that never starts leaves the group
+    barrier.leave();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK(failures == std::vector<int>{1, 1, 1});
+}
+
+TEST_CASE("Adaptive cooling and time budget") {
+    graphw::Graph graph;
+    graph.add_circular_ladder(100);
+    std::vector<size_t> offsets;
+    std::vector<graphw::NodeId> targets;
+    graphw::detail::symmetric_adjacency(graph, offsets, targets);
+    srand(11);
+    const std::vector<graphw::PositionFloat> start =
+        graphw::random_positions(graph.number_of_nodes());
+
+    // A converged layout stops before running every iteration
+    graphw::detail::ForceOptions options;
+    options.iterations = 3000;
+    options.adaptive_cooling = true;
+    options.tolerance = 0.01;
+    std::vector<graphw::PositionFloat> adaptive = start;
+    int iterations = graphw::detail::force_directed_steps(offsets, targets,
+                                                          adaptive, options);
+    CHECK(iterations > 0);
+    CHECK(iterations < 3000);
+    graphw::detail::ForceOptions tolerant = options;
+    tolerant.tolerance = 1000;
+    std::vector<graphw::PositionFloat> unchanged = start;
+    CHECK(graphw::detail::force_directed_steps(offsets, targets, unchanged,
+                                               tolerant) == 0);
+    CHECK(unchanged[0].x == start[0].x);
+    graphw::detail::fit_unit_square(adaptive);
+    double length = 0;
+    for (graphw::NodeId i = 0; i < graph.number_of_nodes(); i++) {
+        for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+            length += hypot(adaptive[i].x - adaptive[targets[e]].x,
+                            adaptive[i].y - adaptive[targets[e]].y);
+        }
+    }
+    CHECK(length / targets.size() < 0.1);
+
+    // A spent time budget keeps the starting positions
+    options.deadline = std::chrono::steady_clock::now();
+    std::vector<graphw::PositionFloat> timed = start;
+    CHECK(graphw::detail::force_directed_steps(offsets, targets, timed,
+                                               options) == 0);
+    for (graphw::NodeId i = 0; i < graph.number_of_nodes(); i++) {
+        CHECK(timed[i].x == start[i].x);
+        CHECK(timed[i].y == start[i].y);
+    }
+    CHECK(graphw::detail::layout_deadline(0) ==
+          std::chrono::steady_clock::time_point::max());
+
+    graphw::ForceDirectedLayout layout;
+    CHECK_FALSE(layout.adaptive_cooling());
+    CHECK(layout.tolerance() == 0);
+    CHECK(layout.time_budget() == 0);
+    layout.set_adaptive_cooling(true);
+    layout.set_tolerance(0.05);
+    layout.set_time_budget(200);
+    CHECK(layout.adaptive_cooling());
+    CHECK(layout.tolerance() == Approx(0.05));
+    CHECK(layout.time_budget() == 200);
+    graphw::detail::ForceOptions layout_options =
+        graphw::detail::force_options(layout);
+    CHECK(layout_options.adaptive_cooling);
+    CHECK(layout_options.deadline <= std::chrono::steady_clock::now() +
+                                         std::chrono::milliseconds(200));
+}
+
+TEST_CASE("Incremental layout") {
+    srand(13);
+    graphw::ForceDirectedLayout layout;
+    layout.add_circular_ladder(50);
+    const std::vector<graphw::PositionFloat> first =
+        graphw::update_positions(layout);
+    REQUIRE(first.size() == 100);
+    std::vector<graphw::PositionFloat> same = graphw::update_positions(layout);
+    for (graphw::NodeId i = 0; i < 100; i++) {
+        CHECK(same[i].x == first[i].x);
+        CHECK(same[i].y == first[i].y);
+    }
+
+    // New nodes are placed near their neighbors and far nodes stay fixed
+    for (int i = 0; i < 5; i++) {
+        layout.add_edge(layout.add_node().id, 0);
+    }
+    std::vector<size_t> offsets;
+    std::vector<graphw::NodeId> targets;
+    graphw::detail::symmetric_adjacency(layout, offsets, targets);
+    const std::vector<graphw::PositionFloat> &updated =
+        graphw::update_positions(layout);
+    REQUIRE(updated.size() == 105);
+    for (graphw::NodeId i = 100; i < 105; i++) {
+        CHECK(hypot(updated[i].x - updated[0].x, updated[i].y - updated[0].y) <
+              0.2);
+    }
+    // Nodes 0, 1, 49, 50, 51 and 99 are within two hops of the new nodes and
+    // their neighbors form the fixed border
+    int moved = 0;
+    for (graphw::NodeId i = 0; i < 100; i++) {
+        if (updated[i].x != first[i].x || updated[i].y != first[i].y) {
+            moved++;
+        }
+    }
+    CHECK(moved <= 6);
+    CHECK(updated[25].x == first[25].x);
+    CHECK(updated[75].y == first[75].y);
+    CHECK(layout.positions_version() == layout.version());
+
+    // Edges between existing nodes refine the whole layout
+    const std::vector<graphw::PositionFloat> grown = updated;
+    const uint64_t version = layout.version();
+    layout.add_edge("10", "35");
+    CHECK(layout.version() == version + 2);
+    CHECK_FALSE(graphw::detail::only_appended(layout, version, 105));
+    const std::vector<graphw::PositionFloat> linked =
+        graphw::update_positions(layout);
+    CHECK(hypot(linked[10].x - linked[35].x, linked[10].y - linked[35].y) <
+          hypot(grown[10].x - grown[35].x, grown[10].y - grown[35].y));
+
+    // A graph rebuilt with the same number of nodes is laid out again
+    layout.clear();
+    for (int i = 0; i < 104; i++) {
+        layout.add_edge(std::to_string(i), std::to_string(i + 1));
+    }
+    REQUIRE(layout.number_of_nodes() == 105);
+    const std::vector<graphw::PositionFloat> &rebuilt =
+        graphw::update_positions(layout);
+    moved = 0;
+    for (graphw::NodeId i = 0; i < 105; i++) {
+        if (rebuilt[i].x != linked[i].x || rebuilt[i].y != linked[i].y) {
+            moved++;
+        }
+    }
+    CHECK(moved == 105);
+
+    // Nodes without placed neighbors get random positions
+    std::vector<graphw::PositionFloat> seeded = {{0.5, 0.5}};
+    std::vector<size_t> isolated_offsets = {0, 0, 0};
+    std::vector<graphw::NodeId> isolated_targets;
+    graphw::detail::seed_new_nodes(isolated_offsets, isolated_targets, seeded,
+                                   1);
+    REQUIRE(seeded.size() == 2);
+    CHECK(seeded[1].x >= 0);
+    CHECK(seeded[1].x <= 1);
+
+    // New nodes are placed breadth first along a chain from a placed node,
+    // which runs against the order of their ids
+    graphw::Graph chain;
+    chain.add_empty(400);
+    chain.add_edge(0, 399);
+    chain.add_edge(399, 398);
+    chain.add_edge(398, 397);
+    std::vector<size_t> chain_offsets;
+    std::vector<graphw::NodeId> chain_targets;
+    graphw::detail::symmetric_adjacency(chain, chain_offsets, chain_targets);
+    seeded.assign(397, {0.5, 0.5});
+    graphw::detail::seed_new_nodes(chain_offsets, chain_targets, seeded, 397);
+    REQUIRE(seeded.size() == 400);
+    for (graphw::NodeId i = 397; i < 400; i++) {
+        CHECK(std::abs(seeded[i].x - 0.5) < 0.1);
+        CHECK(std::abs(seeded[i].y - 0.5) < 0.1);
+    }
+
+    // Fixed nodes do not move
+    graphw::detail::ForceOptions options;
+    options.iterations = 10;
+    options.movable = 50;
+    std::vector<graphw::PositionFloat> positions = first;
+    graphw::Graph ladder;
+    ladder.add_circular_ladder(50);
+    graphw::detail::symmetric_adjacency(ladder, offsets, targets);
+    graphw::detail::force_directed_steps(offsets, targets, positions, options);
+    for (graphw::NodeId i = 50; i < 100; i++) {
+        CHECK(positions[i].x == first[i].x);
+    }
+
+    layout.set_positions({});
+    CHECK(graphw::update_layout(layout, 640, 480).size() == 105);
+    CHECK(layout.positions().size() == 105);
+}
+
+TEST_CASE("Rotation position generators") {
+    using graphw::detail::SimdLevel;
+    // Kernels match direct sines and cosines, including partial lanes
+    for (SimdLevel level : {SimdLevel::scalar, SimdLevel::avx2}) {
+        std::vector<graphw::PositionFloat> positions(1003);
+        graphw::detail::rotation(positions.data(), 3, 1003, 0.01, 2, 0.5,
+                                 level);
+        for (size_t i = 3; i < 1003; i++) {
+            double distance = 2 + (i * 0.5);
+            CHECK(positions[i].x ==
+                  Approx(cos(i * 0.01) * distance).margin(0.0001));
+            CHECK(positions[i].y ==
+                  Approx(sin(i * 0.01) * distance).margin(0.0001));
+        }
+    }
+
+    // Circles and spirals spanning several chunks
+    const graphw::NodeId nodes = 150000;
+    std::vector<graphw::PositionFloat> circle =
+        graphw::detail::circle_positions(nodes);
+    REQUIRE(circle.size() == nodes);
+    for (graphw::NodeId i = 0; i < nodes; i += 101) {
+        double angle = (2 * M_PI * i) / nodes;
+        CHECK(circle[i].x == Approx(cos(angle)).margin(0.000001));
+        CHECK(circle[i].y == Approx(sin(angle)).margin(0.000001));
+    }
+    graphw::SpiralLayout spiral;
+    spiral.add_empty(nodes);
+    std::vector<graphw::PositionFloat> positions =
+        graphw::detail::spiral_positions(spiral);
+    REQUIRE(positions.size() == nodes);
+    for (graphw::NodeId i = 0; i < nodes; i += 101) {
+        double angle = i * (double)spiral.resolution();
+        CHECK(positions[i].x == Approx(cos(angle) * i).margin(0.01));
+        CHECK(positions[i].y == Approx(sin(angle) * i).margin(0.01));
+    }
+    spiral.set_equidistant(true);
+    positions = graphw::detail::spiral_positions(spiral);
+    REQUIRE(positions.size() == nodes);
+    float theta = spiral.resolution();
+    for (graphw::NodeId i = 0; i <= nodes; i++) {
+        float radius = 0.5 * theta;
+        theta += 1 / radius;
+        if (i > 0 && (i - 1) % 101 == 0) {
+            CHECK(positions[i - 1].x ==
+                  Approx(cos((double)theta) * radius).margin(0.001));
+            CHECK(positions[i - 1].y ==
+                  Approx(sin((double)theta) * radius).margin(0.001));
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#include "graphw_view.hpp"
+
+#include <catch2/catch.hpp>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "graphw.hpp"
+#include "graphw_csr.hpp"
+
+TEST_CASE("Induced subgraph view") {
+    graphw::Graph graph;
+    graph.add_circulant(10, {1});
+    graph.add_edge("0", "5");
+    graph.add_edge("3", "3");
+    graph.set_attribute("weight", "5", 2.5);
+    graphw::GraphView view = graphw::subgraph(graph, {5, 0, 1, 3, 0});
+
+    CHECK(view.number_of_nodes() == 4);
+    CHECK(view.node(0) == 0);
+    CHECK(view.node(3) == 5);
+    CHECK(view.index(5) == 3);
+    CHECK(view.contains(3));
+    CHECK_FALSE(view.contains(2));
+    CHECK_FALSE(view.contains(42));
+    CHECK(view.number_of_edges() == 3);
+    CHECK(view.get_neighbors("0") == std::list<std::string>{"1", "5"});
+    CHECK(view.degree("3") == 2);
+    CHECK(view.neighbors(2).size() == 0);
+    REQUIRE_THROWS(view.degree("2"));
+    REQUIRE_THROWS(graphw::subgraph(graph, {10}));
+
+    graphw::GraphView labelled =
+        graphw::subgraph(graph, {graph.id("5"), graph.id("0")});
+    CHECK(labelled.number_of_edges() == 1);
+
+    graphw::CSRGraph csr = view.materialize();
+    CHECK(csr.number_of_nodes() == 4);
+    CHECK(csr.number_of_edges() == 3);
+    CHECK(csr.label(3) == "5");
+    CHECK(csr.get_neighbors("0") == std::list<std::string>{"1", "5"});
+    CHECK(csr.attribute("weight", "5") == 2.5);
+    CHECK(csr.attribute("weight", "1") == 0.0);
+
+    graphw::CircularLayout layout = view.to_graph<graphw::CircularLayout>();
+    CHECK(layout.number_of_nodes() == 4);
+    CHECK(layout.number_of_edges() == 3);
+    CHECK(layout.get_neighbors("5") == std::list<std::string>{"0"});
+    CHECK(layout.attribute("weight", "5") == 2.5);
+    CHECK(layout.graph[3][0].id == 0);
+}
+
+TEST_CASE("Filtered graph views") {
+    graphw::Graph graph(true);
+    graph.add_complete(6);
+    graphw::GraphView increasing = graphw::edge_subgraph(
+        graph, [](graphw::NodeId id1, graphw::NodeId id2) {
+            return id1 < id2;
+        });
+
+    CHECK(increasing.number_of_nodes() == 6);
+    CHECK(increasing.number_of_edges() == 15);
+    CHECK(increasing.degree("0") == 5);
+    CHECK(increasing.degree("5") == 0);
+
+    graphw::GraphView even = graphw::filtered(
+        graph, [](graphw::NodeId id) { return id % 2 == 0; },
+        [](graphw::NodeId id1, graphw::NodeId) { return id1 != 2; });
+    CHECK(even.number_of_nodes() == 3);
+    CHECK(even.number_of_edges() == 2);
+    CHECK(even.get_neighbors("2").empty());
+
+    graphw::Graph copy = even.to_graph();
+    CHECK(copy.directed());
+    CHECK(copy.get_adjacency_list() == "0 2 4 \n2 \n4 \n");
+    CHECK(graphw::GraphView(graph).materialize().get_adjacency_list() ==
+          graph.get_adjacency_list());
+}